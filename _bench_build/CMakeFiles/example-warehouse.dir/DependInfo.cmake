@@ -0,0 +1,20 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/examples/warehouse/main.cpp" "CMakeFiles/example-warehouse.dir/examples/warehouse/main.cpp.o" "gcc" "CMakeFiles/example-warehouse.dir/examples/warehouse/main.cpp.o.d"
+  "/root/repo/examples/warehouse/warehouseapp.cpp" "CMakeFiles/example-warehouse.dir/examples/warehouse/warehouseapp.cpp.o" "gcc" "CMakeFiles/example-warehouse.dir/examples/warehouse/warehouseapp.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
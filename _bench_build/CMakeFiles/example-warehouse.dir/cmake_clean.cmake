@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/example-warehouse.dir/examples/warehouse/main.cpp.o"
+  "CMakeFiles/example-warehouse.dir/examples/warehouse/main.cpp.o.d"
+  "CMakeFiles/example-warehouse.dir/examples/warehouse/warehouseapp.cpp.o"
+  "CMakeFiles/example-warehouse.dir/examples/warehouse/warehouseapp.cpp.o.d"
+  "example-warehouse"
+  "example-warehouse.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example-warehouse.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
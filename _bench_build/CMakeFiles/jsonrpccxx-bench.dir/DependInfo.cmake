@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/bench/client.cpp" "CMakeFiles/jsonrpccxx-bench.dir/bench/client.cpp.o" "gcc" "CMakeFiles/jsonrpccxx-bench.dir/bench/client.cpp.o.d"
+  "/root/repo/bench/dispatcher.cpp" "CMakeFiles/jsonrpccxx-bench.dir/bench/dispatcher.cpp.o" "gcc" "CMakeFiles/jsonrpccxx-bench.dir/bench/dispatcher.cpp.o.d"
+  "/root/repo/bench/handle.cpp" "CMakeFiles/jsonrpccxx-bench.dir/bench/handle.cpp.o" "gcc" "CMakeFiles/jsonrpccxx-bench.dir/bench/handle.cpp.o.d"
+  "/root/repo/bench/main.cpp" "CMakeFiles/jsonrpccxx-bench.dir/bench/main.cpp.o" "gcc" "CMakeFiles/jsonrpccxx-bench.dir/bench/main.cpp.o.d"
+  "/root/repo/bench/server.cpp" "CMakeFiles/jsonrpccxx-bench.dir/bench/server.cpp.o" "gcc" "CMakeFiles/jsonrpccxx-bench.dir/bench/server.cpp.o.d"
+  "/root/repo/examples/warehouse/warehouseapp.cpp" "CMakeFiles/jsonrpccxx-bench.dir/examples/warehouse/warehouseapp.cpp.o" "gcc" "CMakeFiles/jsonrpccxx-bench.dir/examples/warehouse/warehouseapp.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
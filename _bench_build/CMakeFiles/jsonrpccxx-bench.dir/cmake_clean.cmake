@@ -0,0 +1,21 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/client.cpp.o"
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/client.cpp.o.d"
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/dispatcher.cpp.o"
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/dispatcher.cpp.o.d"
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/handle.cpp.o"
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/handle.cpp.o.d"
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/main.cpp.o"
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/main.cpp.o.d"
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/server.cpp.o"
+  "CMakeFiles/jsonrpccxx-bench.dir/bench/server.cpp.o.d"
+  "CMakeFiles/jsonrpccxx-bench.dir/examples/warehouse/warehouseapp.cpp.o"
+  "CMakeFiles/jsonrpccxx-bench.dir/examples/warehouse/warehouseapp.cpp.o.d"
+  "jsonrpccxx-bench"
+  "jsonrpccxx-bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/jsonrpccxx-bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
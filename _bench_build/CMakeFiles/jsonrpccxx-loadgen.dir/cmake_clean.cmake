@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/jsonrpccxx-loadgen.dir/bench/loadgen.cpp.o"
+  "CMakeFiles/jsonrpccxx-loadgen.dir/bench/loadgen.cpp.o.d"
+  "CMakeFiles/jsonrpccxx-loadgen.dir/examples/warehouse/warehouseapp.cpp.o"
+  "CMakeFiles/jsonrpccxx-loadgen.dir/examples/warehouse/warehouseapp.cpp.o.d"
+  "jsonrpccxx-loadgen"
+  "jsonrpccxx-loadgen.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/jsonrpccxx-loadgen.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal Google-Benchmark-style harness, so benchmarks can be built without additional dependencies
+namespace bench {
+  class State {
+  public:
+    explicit State(uint64_t iterations) : iterations(iterations), remaining(iterations), items(0), bytes(0) {}
+
+    bool KeepRunning() {
+      if (remaining == 0)
+        return false;
+      remaining--;
+      return true;
+    }
+    uint64_t Iterations() const { return iterations; }
+
+    void SetItemsProcessed(uint64_t count) { items = count; }
+    void SetBytesProcessed(uint64_t count) { bytes = count; }
+    uint64_t ItemsProcessed() const { return items; }
+    uint64_t BytesProcessed() const { return bytes; }
+
+  private:
+    uint64_t iterations;
+    uint64_t remaining;
+    uint64_t items;
+    uint64_t bytes;
+  };
+
+  typedef std::function<void(State &)> Function;
+
+  struct Benchmark {
+    std::string name;
+    Function function;
+  };
+
+  inline std::vector<Benchmark> &registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+  }
+
+  struct Registrar {
+    Registrar(const std::string &name, Function function) { registry().push_back({name, std::move(function)}); }
+  };
+
+  // Prevents the compiler from optimizing away otherwise unused results
+  template <typename T>
+  inline void DoNotOptimize(T &&value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+  }
+} // namespace bench
+
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+#define BENCHMARK_CASE_IMPL(name, function)                                                                                                                    \
+  static void function(bench::State &);                                                                                                                        \
+  static bench::Registrar BENCHMARK_CONCAT(function, _registrar)(name, function);                                                                              \
+  static void function(bench::State &state)
+#define BENCHMARK_CASE(name) BENCHMARK_CASE_IMPL(name, BENCHMARK_CONCAT(benchmark_case_, __LINE__))
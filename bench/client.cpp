@@ -0,0 +1,139 @@
+#include "benchmark.hpp"
+#include "inmemoryconnector.hpp"
+#include <jsonrpccxx/batchclient.hpp>
+#include <jsonrpccxx/client.hpp>
+#include <jsonrpccxx/server.hpp>
+
+using namespace jsonrpccxx;
+
+static int add(int a, int b) { return a + b; }
+static std::vector<int> range(int count) {
+  std::vector<int> result(static_cast<size_t>(count));
+  for (int i = 0; i < count; i++)
+    result[static_cast<size_t>(i)] = i * 1000;
+  return result;
+}
+
+struct BenchmarkClient {
+  BenchmarkClient() : server(), connector(server), client(connector) {
+    server.Add("add", GetHandle(&add), {"a", "b"});
+    server.Add("range", GetHandle(&range), {"count"});
+  }
+  JsonRpc2Server server;
+  InMemoryConnector connector;
+  BatchClient client;
+};
+
+BENCHMARK_CASE("CallMethod/positional") {
+  BenchmarkClient c;
+  while (state.KeepRunning()) {
+    int result = c.client.CallMethod<int>(1, "add", {3, 4});
+    bench::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK_CASE("CallMethod/named") {
+  BenchmarkClient c;
+  while (state.KeepRunning()) {
+    int result = c.client.CallMethodNamed<int>(1, "add", {{"a", 3}, {"b", 4}});
+    bench::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK_CASE("PreparedCall/positional") {
+  BenchmarkClient c;
+  PreparedCall add = c.client.Prepare("add");
+  while (state.KeepRunning()) {
+    int result = add.Call<int>(1, {3, 4});
+    bench::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK_CASE("PreparedCall/named") {
+  BenchmarkClient c;
+  PreparedCall add = c.client.Prepare("add");
+  while (state.KeepRunning()) {
+    int result = add.CallNamed<int>(1, {{"a", 3}, {"b", 4}});
+    bench::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK_CASE("RemoteMethod/positional") {
+  BenchmarkClient c;
+  auto add = c.client.Remote<int(int, int)>("add");
+  while (state.KeepRunning()) {
+    int result = add(3, 4);
+    bench::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK_CASE("RemoteMethod/named") {
+  BenchmarkClient c;
+  auto add = c.client.Remote<int(int, int)>("add", {"a", "b"});
+  while (state.KeepRunning()) {
+    int result = add(3, 4);
+    bench::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK_CASE("CallMethod/large_result") {
+  BenchmarkClient c;
+  while (state.KeepRunning()) {
+    std::vector<int> result = c.client.CallMethod<std::vector<int>>(1, "range", {10000});
+    bench::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.Iterations() * 10000);
+}
+
+BENCHMARK_CASE("CallMethod/large_result_json") {
+  BenchmarkClient c;
+  while (state.KeepRunning()) {
+    json result = c.client.CallMethod<json>(1, "range", {10000});
+    bench::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.Iterations() * 10000);
+}
+
+static void batch_call(bench::State &state, int size) {
+  BenchmarkClient c;
+  BatchRequest request;
+  for (int i = 0; i < size; i++)
+    request.AddMethodCall(i, "add", {i, 1});
+  while (state.KeepRunning()) {
+    BatchResponse response = c.client.BatchCall(request);
+    int result = response.Get<int>(size - 1);
+    bench::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.Iterations() * static_cast<uint64_t>(size));
+}
+
+static void lazy_batch_call(bench::State &state, int size) {
+  BenchmarkClient c;
+  BatchRequest request;
+  for (int i = 0; i < size; i++)
+    request.AddMethodCall(i, "add", {i, 1});
+  while (state.KeepRunning()) {
+    LazyBatchResponse response = c.client.LazyBatchCall(request);
+    int result = response.Get<int>(size - 1);
+    bench::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.Iterations() * static_cast<uint64_t>(size));
+}
+
+BENCHMARK_CASE("BatchRequest/build_10000") {
+  while (state.KeepRunning()) {
+    BatchRequest request;
+    request.Reserve(10000 * 64);
+    for (int i = 0; i < 10000; i++)
+      request.AddMethodCall(i, "add", {i, 1});
+    bench::DoNotOptimize(request.Serialize());
+  }
+  state.SetItemsProcessed(state.Iterations() * 10000);
+}
+
+BENCHMARK_CASE("BatchCall/10") { batch_call(state, 10); }
+BENCHMARK_CASE("BatchCall/100") { batch_call(state, 100); }
+BENCHMARK_CASE("BatchCall/1000") { batch_call(state, 1000); }
+BENCHMARK_CASE("LazyBatchCall/10") { lazy_batch_call(state, 10); }
+BENCHMARK_CASE("LazyBatchCall/100") { lazy_batch_call(state, 100); }
+BENCHMARK_CASE("LazyBatchCall/1000") { lazy_batch_call(state, 1000); }
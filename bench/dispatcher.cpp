@@ -0,0 +1,66 @@
+#include "benchmark.hpp"
+#include <jsonrpccxx/dispatcher.hpp>
+#include <jsonrpccxx/staticdispatcher.hpp>
+#include <thread>
+
+using namespace jsonrpccxx;
+
+static int add(int a, int b) { return a + b; }
+
+static void invoke(bench::State &state, Dispatcher &d) {
+  json params = {3, 4};
+  while (state.KeepRunning()) {
+    json result = d.InvokeMethod("add", params);
+    bench::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK_CASE("Dispatcher/InvokeMethod") {
+  Dispatcher d;
+  d.Add("add", GetHandle(&add));
+  invoke(state, d);
+}
+
+struct NoInstance {};
+static constexpr char addName[] = "add";
+
+BENCHMARK_CASE("StaticDispatcher/InvokeMethod") {
+  NoInstance instance;
+  StaticDispatcher<NoInstance, Methods<Method<addName, &add>>> d(instance);
+  json params = {3, 4};
+  while (state.KeepRunning()) {
+    json result = d.InvokeMethod("add", params);
+    bench::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK_CASE("Dispatcher/InvokeMethod/statistics") {
+  Dispatcher d;
+  d.Add("add", GetHandle(&add));
+  d.EnableStatistics();
+  invoke(state, d);
+}
+
+BENCHMARK_CASE("Dispatcher/InvokeMethod/statistics/4threads") {
+  Dispatcher d;
+  d.Add("add", GetHandle(&add));
+  d.EnableStatistics();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&d, iterations = state.Iterations() / 4]() {
+      bench::State s(iterations);
+      invoke(s, d);
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+}
+
+BENCHMARK_CASE("MethodStatistics/Record") {
+  MethodStatistics s;
+  uint64_t latency = 0;
+  while (state.KeepRunning()) {
+    s.Record(latency++ & 0xfffff);
+  }
+  bench::DoNotOptimize(s);
+}
@@ -0,0 +1,78 @@
+#include "benchmark.hpp"
+#include "warehouse/warehouseapp.hpp"
+#include <jsonrpccxx/typemapper.hpp>
+
+using namespace jsonrpccxx;
+
+// Binding as done before MethodHandle stored callables directly: the member call wrapped in a std::function,
+// which is captured by the handle lambda, which is stored in another std::function.
+template <typename ReturnType, typename... ParamTypes, std::size_t... index>
+static std::function<json(const json &)> nested_handle(std::function<ReturnType(ParamTypes...)> function, std::index_sequence<index...>) {
+  return [function](const json &params) -> json {
+    check_params<ParamTypes...>(params, std::index_sequence<index...>{});
+    return function(params[index].get<typename std::decay<ParamTypes>::type>()...);
+  };
+}
+
+template <typename ReturnType, typename... ParamTypes>
+static std::function<json(const json &)> nested_handle(ReturnType (WarehouseServer::*method)(ParamTypes...), WarehouseServer &instance) {
+  std::function<ReturnType(ParamTypes...)> function = [&instance, method](ParamTypes &&... params) -> ReturnType {
+    return (instance.*method)(std::forward<ParamTypes>(params)...);
+  };
+  return nested_handle(function, std::index_sequence_for<ParamTypes...>{});
+}
+
+static Product product(const std::string &id) {
+  Product p;
+  p.id = id;
+  p.price = 22.4;
+  p.name = "Product " + id;
+  p.cat = category::cash_carry;
+  return p;
+}
+
+template <typename Handle>
+static void call(bench::State &state, const Handle &handle, const json &params) {
+  while (state.KeepRunning()) {
+    json result = handle(params);
+    bench::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK_CASE("MethodHandle/warehouse/GetProduct") {
+  WarehouseServer app;
+  app.AddProduct(product("1"));
+  call(state, GetHandle(&WarehouseServer::GetProduct, app), {"1"});
+}
+
+BENCHMARK_CASE("MethodHandle/warehouse/GetProduct/nested_std_function") {
+  WarehouseServer app;
+  app.AddProduct(product("1"));
+  call(state, nested_handle(&WarehouseServer::GetProduct, app), {"1"});
+}
+
+BENCHMARK_CASE("MethodHandle/warehouse/AddProduct") {
+  WarehouseServer app;
+  call(state, GetHandle(&WarehouseServer::AddProduct, app), {product("1")});
+}
+
+BENCHMARK_CASE("MethodHandle/warehouse/AddProduct/nested_std_function") {
+  WarehouseServer app;
+  call(state, nested_handle(&WarehouseServer::AddProduct, app), {product("1")});
+}
+
+BENCHMARK_CASE("MethodHandle/warehouse/bind") {
+  WarehouseServer app;
+  while (state.KeepRunning()) {
+    MethodHandle handle = GetHandle(&WarehouseServer::GetProduct, app);
+    bench::DoNotOptimize(handle);
+  }
+}
+
+BENCHMARK_CASE("MethodHandle/warehouse/bind/nested_std_function") {
+  WarehouseServer app;
+  while (state.KeepRunning()) {
+    auto handle = nested_handle(&WarehouseServer::GetProduct, app);
+    bench::DoNotOptimize(handle);
+  }
+}
@@ -0,0 +1,311 @@
+// End-to-end load generator: drives a JSON-RPC server through an IClientConnector and reports throughput and
+// latency percentiles. In open-loop mode (--rate) latencies are measured from the time a request was scheduled,
+// not from the time it was sent, which corrects for coordinated omission when the server falls behind.
+#include "cpphttplibconnector.hpp"
+#include "inmemoryconnector.hpp"
+#include "warehouse/warehouseapp.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <jsonrpccxx/batchclient.hpp>
+#include <jsonrpccxx/client.hpp>
+#include <jsonrpccxx/server.hpp>
+#include <jsonrpccxx/statistics.hpp>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+struct Options {
+  Options() : transport("memory"), host("localhost"), port(8484), serve(false), concurrency(4), rate(0), duration(5), batch(1), products(1000), format("console"), mix() {}
+  string transport;
+  string host;
+  int port;
+  bool serve;
+  size_t concurrency;
+  double rate;
+  double duration;
+  size_t batch;
+  size_t products;
+  string format;
+  vector<pair<string, unsigned>> mix;
+};
+
+// Warehouse bindings guarded by a mutex, WarehouseServer itself is not thread-safe
+class WarehouseService {
+public:
+  WarehouseService() : mutex(), app() {}
+
+  void Bind(JsonRpcServer &server) {
+    server.Add("GetProduct", GetHandle(std::function<Product(const string &)>([this](const string &id) {
+                 lock_guard<std::mutex> lock(mutex);
+                 return app.GetProduct(id);
+               })),
+               {"id"});
+    server.Add("AddProduct", GetHandle(std::function<bool(const Product &)>([this](const Product &p) {
+                 lock_guard<std::mutex> lock(mutex);
+                 return app.AddProduct(p);
+               })),
+               {"product"});
+    server.Add("AllProducts", GetHandle(std::function<vector<Product>()>([this]() {
+                 lock_guard<std::mutex> lock(mutex);
+                 return app.AllProducts();
+               })),
+               {});
+  }
+
+private:
+  std::mutex mutex;
+  WarehouseServer app;
+};
+
+static Product product(const string &id) {
+  Product p;
+  p.id = id;
+  p.price = 22.4;
+  p.name = "Product " + id;
+  p.cat = category::cash_carry;
+  return p;
+}
+
+class Worker {
+public:
+  Worker(const Options &options, IClientConnector &connector, size_t index)
+      : options(options), client(connector), random(static_cast<unsigned>(index) + 1), index(index), added(0) {}
+
+  pair<string, positional_parameter> Next() {
+    unsigned total = 0;
+    for (auto &m : options.mix)
+      total += m.second;
+    unsigned pick = uniform_int_distribution<unsigned>(0, total - 1)(random);
+    for (auto &m : options.mix) {
+      if (pick < m.second)
+        return {m.first, params(m.first)};
+      pick -= m.second;
+    }
+    return {options.mix.back().first, params(options.mix.back().first)};
+  }
+
+  void Call(const string &method, const positional_parameter &p) { client.CallMethod<json>(1, method, p); }
+
+  void Batch(const vector<pair<string, positional_parameter>> &calls) {
+    BatchRequest request;
+    for (size_t i = 0; i < calls.size(); i++)
+      request.AddMethodCall(static_cast<int>(i), calls[i].first, calls[i].second);
+    BatchResponse response = client.BatchCall(request);
+    for (size_t i = 0; i < calls.size(); i++)
+      response.Get<json>(static_cast<int>(i));
+  }
+
+private:
+  const Options &options;
+  BatchClient client;
+  mt19937 random;
+  size_t index;
+  size_t added;
+
+  positional_parameter params(const string &method) {
+    if (method == "GetProduct")
+      return {to_string(uniform_int_distribution<size_t>(0, options.products - 1)(random))};
+    if (method == "AddProduct")
+      return {product("w" + to_string(index) + "-" + to_string(added++))};
+    return {};
+  }
+};
+
+static bool parse_mix(const string &value, vector<pair<string, unsigned>> &mix) {
+  mix.clear();
+  stringstream stream(value);
+  string entry;
+  while (getline(stream, entry, ',')) {
+    size_t colon = entry.find(':');
+    unsigned weight = colon == string::npos ? 1 : static_cast<unsigned>(stoul(entry.substr(colon + 1)));
+    if (weight > 0)
+      mix.emplace_back(entry.substr(0, colon), weight);
+  }
+  return !mix.empty();
+}
+
+static bool parse_options(int argc, char **argv, Options &o) {
+  parse_mix("GetProduct:95,AddProduct:5", o.mix);
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    size_t eq = arg.find('=');
+    string key = arg.substr(0, eq);
+    string value = eq == string::npos ? "" : arg.substr(eq + 1);
+    if (key == "--transport" && (value == "memory" || value == "http"))
+      o.transport = value;
+    else if (key == "--host")
+      o.host = value;
+    else if (key == "--port")
+      o.port = stoi(value);
+    else if (key == "--serve")
+      o.serve = true;
+    else if (key == "--concurrency")
+      o.concurrency = max<size_t>(1, stoul(value));
+    else if (key == "--rate")
+      o.rate = stod(value);
+    else if (key == "--duration")
+      o.duration = stod(value);
+    else if (key == "--batch")
+      o.batch = max<size_t>(1, stoul(value));
+    else if (key == "--products")
+      o.products = max<size_t>(1, stoul(value));
+    else if (key == "--format" && (value == "console" || value == "json"))
+      o.format = value;
+    else if (key == "--mix" && parse_mix(value, o.mix))
+      continue;
+    else
+      return false;
+  }
+  return true;
+}
+
+static json report(const string &name, const MethodStatisticsSnapshot &s, double elapsed) {
+  json errors = json::object();
+  for (size_t i = 0; i < error_type_count; i++) {
+    if (s.errors[i] != 0)
+      errors[error_type_name(i)] = s.errors[i];
+  }
+  return {{"name", name},
+          {"requests", s.calls},
+          {"errors", errors},
+          {"throughput", static_cast<double>(s.calls) / elapsed},
+          {"latency_us",
+           {{"mean", s.Mean() / 1e3},
+            {"p50", s.Percentile(0.5) / 1e3},
+            {"p90", s.Percentile(0.9) / 1e3},
+            {"p99", s.Percentile(0.99) / 1e3},
+            {"p999", s.Percentile(0.999) / 1e3},
+            {"max", s.max_ns / 1e3}}}};
+}
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    cerr << "usage: " << argv[0]
+         << " [--transport=memory|http] [--host=<host>] [--port=<port>] [--serve] [--concurrency=<threads>] [--rate=<requests/s>]"
+            " [--duration=<seconds>] [--batch=<size>] [--mix=<method:weight,...>] [--products=<count>] [--format=console|json]\n";
+    return 1;
+  }
+
+  JsonRpc2Server server;
+  WarehouseService service;
+  service.Bind(server);
+  unique_ptr<CppHttpLibServerConnector> httpServer;
+  if (options.transport == "http" && options.serve) {
+    httpServer = std::make_unique<CppHttpLibServerConnector>(server, options.port);
+    httpServer->StartListening();
+    this_thread::sleep_for(chrono::milliseconds(500));
+  }
+
+  auto connect = [&options, &server]() -> unique_ptr<IClientConnector> {
+    if (options.transport == "http")
+      return std::make_unique<CppHttpLibClientConnector>(options.host, options.port);
+    return std::make_unique<InMemoryConnector>(server);
+  };
+
+  {
+    auto connector = connect();
+    JsonRpcClient client(*connector, version::v2);
+    for (size_t i = 0; i < options.products; i++)
+      client.CallMethod<bool>(1, "AddProduct", {product(to_string(i))});
+  }
+
+  map<string, MethodStatistics> statistics;
+  for (auto &m : options.mix)
+    statistics[m.first];
+  statistics["batch"];
+
+  atomic<uint64_t> scheduled(0);
+  const auto interval = options.rate > 0 ? chrono::nanoseconds(static_cast<int64_t>(1e9 * static_cast<double>(options.batch) / options.rate)) : chrono::nanoseconds(0);
+  const auto start = chrono::steady_clock::now();
+  const auto end = start + chrono::nanoseconds(static_cast<int64_t>(options.duration * 1e9));
+
+  vector<thread> threads;
+  for (size_t t = 0; t < options.concurrency; t++) {
+    threads.emplace_back([&, t]() {
+      auto connector = connect();
+      Worker worker(options, *connector, t);
+      while (true) {
+        auto intended = chrono::steady_clock::now();
+        if (options.rate > 0) {
+          intended = start + interval * static_cast<int64_t>(scheduled.fetch_add(1));
+          if (intended >= end)
+            break;
+          this_thread::sleep_until(intended);
+        } else if (intended >= end) {
+          break;
+        }
+        vector<pair<string, positional_parameter>> calls;
+        for (size_t i = 0; i < options.batch; i++)
+          calls.push_back(worker.Next());
+        MethodStatistics &s = statistics.at(options.batch > 1 ? "batch" : calls[0].first);
+        try {
+          if (options.batch > 1)
+            worker.Batch(calls);
+          else
+            worker.Call(calls[0].first, calls[0].second);
+          s.Record(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - intended).count()));
+        } catch (JsonRpcException &e) {
+          s.Record(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - intended).count()), e.Code());
+        }
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  json results = json::array();
+  MethodStatisticsSnapshot total;
+  for (auto &s : statistics) {
+    MethodStatisticsSnapshot snapshot = s.second.Snapshot();
+    if (snapshot.calls == 0)
+      continue;
+    results.push_back(report(s.first, snapshot, elapsed));
+    total.calls += snapshot.calls;
+    total.total_ns += snapshot.total_ns;
+    total.max_ns = max(total.max_ns, snapshot.max_ns);
+    for (size_t i = 0; i < error_type_count; i++)
+      total.errors[i] += snapshot.errors[i];
+    for (size_t i = 0; i < histogram::bucket_count; i++)
+      total.buckets[i] += snapshot.buckets[i];
+  }
+  results.push_back(report("total", total, elapsed));
+
+  if (options.format == "json") {
+    cout << json{{"transport", options.transport},
+                 {"concurrency", options.concurrency},
+                 {"rate", options.rate},
+                 {"batch", options.batch},
+                 {"duration", elapsed},
+                 {"coordinated_omission_corrected", options.rate > 0},
+                 {"results", results}}
+                .dump(2)
+         << endl;
+    return 0;
+  }
+  char rate[32] = "max";
+  if (options.rate > 0)
+    snprintf(rate, sizeof(rate), "%.0f/s", options.rate);
+  printf("transport=%s concurrency=%zu rate=%s batch=%zu duration=%.1fs%s\n", options.transport.c_str(), options.concurrency, rate, options.batch, elapsed,
+         options.rate > 0 ? "" : " (closed loop, latencies not corrected for coordinated omission)");
+  printf("%-14s %10s %8s %12s %10s %10s %10s %10s %10s\n", "method", "requests", "errors", "req/s", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+  for (auto &r : results) {
+    uint64_t errors = 0;
+    for (auto &e : r["errors"])
+      errors += e.get<uint64_t>();
+    printf("%-14s %10llu %8llu %12.0f %10.1f %10.1f %10.1f %10.1f %10.1f\n", r["name"].get<string>().c_str(), r["requests"].get<unsigned long long>(),
+           static_cast<unsigned long long>(errors), r["throughput"].get<double>(), r["latency_us"]["p50"].get<double>(), r["latency_us"]["p90"].get<double>(),
+           r["latency_us"]["p99"].get<double>(), r["latency_us"]["p999"].get<double>(), r["latency_us"]["max"].get<double>());
+  }
+  return 0;
+}
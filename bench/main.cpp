@@ -0,0 +1,104 @@
+#include "benchmark.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+struct Result {
+  string name;
+  uint64_t iterations;
+  double real_time;
+  double cpu_time;
+  double items_per_second;
+  double bytes_per_second;
+};
+
+static Result run(const bench::Benchmark &b, double min_time) {
+  uint64_t iterations = 1;
+  while (true) {
+    bench::State state(iterations);
+    clock_t cpu_start = clock();
+    auto start = chrono::steady_clock::now();
+    b.function(state);
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double cpu = static_cast<double>(clock() - cpu_start) / CLOCKS_PER_SEC;
+    if (elapsed >= min_time || iterations >= (uint64_t(1) << 40)) {
+      auto n = static_cast<double>(iterations);
+      double items = state.ItemsProcessed() != 0 ? static_cast<double>(state.ItemsProcessed()) : n;
+      return {b.name, iterations, elapsed * 1e9 / n, cpu * 1e9 / n, items / elapsed, static_cast<double>(state.BytesProcessed()) / elapsed};
+    }
+    double estimate = elapsed > 0 ? min_time * 1.2 / elapsed * static_cast<double>(iterations) : static_cast<double>(iterations) * 100;
+    iterations = std::max(iterations * 2, std::min(iterations * 100, static_cast<uint64_t>(estimate)));
+  }
+}
+
+// Same layout as Google Benchmark's --benchmark_format=json, so existing tooling can compare runs
+static nlohmann::json to_json(const vector<Result> &results) {
+  char date[64];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+  nlohmann::json benchmarks = nlohmann::json::array();
+  for (const auto &r : results) {
+    nlohmann::json b = {{"name", r.name},     {"run_name", r.name},  {"run_type", "iteration"},  {"iterations", r.iterations},
+                        {"real_time", r.real_time}, {"cpu_time", r.cpu_time}, {"time_unit", "ns"}, {"items_per_second", r.items_per_second}};
+    if (r.bytes_per_second > 0)
+      b["bytes_per_second"] = r.bytes_per_second;
+    benchmarks.push_back(b);
+  }
+#ifdef NDEBUG
+  const char *build_type = "release";
+#else
+  const char *build_type = "debug";
+#endif
+  return {{"context", {{"date", date}, {"num_cpus", thread::hardware_concurrency()}, {"library_build_type", build_type}}}, {"benchmarks", benchmarks}};
+}
+
+int main(int argc, char **argv) {
+  string filter;
+  string format = "console";
+  string out;
+  double min_time = 0.5;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--filter=", 9) == 0) {
+      filter = argv[i] + 9;
+    } else if (strncmp(argv[i], "--min-time=", 11) == 0) {
+      min_time = stod(argv[i] + 11);
+    } else if (strncmp(argv[i], "--format=", 9) == 0 && (strcmp(argv[i] + 9, "console") == 0 || strcmp(argv[i] + 9, "json") == 0)) {
+      format = argv[i] + 9;
+    } else if (strncmp(argv[i], "--out=", 6) == 0) {
+      out = argv[i] + 6;
+    } else {
+      fprintf(stderr, "usage: %s [--filter=<substring>] [--min-time=<seconds>] [--format=console|json] [--out=<file>]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  vector<Result> results;
+  if (format == "console")
+    printf("%-50s %15s %15s %15s %15s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations", "Items/s");
+  for (const auto &b : bench::registry()) {
+    if (!filter.empty() && b.name.find(filter) == string::npos)
+      continue;
+    Result r = run(b, min_time);
+    if (format == "console") {
+      printf("%-50s %15.1f %15.1f %15llu %15.0f\n", r.name.c_str(), r.real_time, r.cpu_time, static_cast<unsigned long long>(r.iterations), r.items_per_second);
+      fflush(stdout);
+    }
+    results.push_back(r);
+  }
+
+  if (format == "json")
+    cout << to_json(results).dump(2) << endl;
+  if (!out.empty()) {
+    ofstream file(out);
+    file << to_json(results).dump(2) << endl;
+  }
+  return 0;
+}
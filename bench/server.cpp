@@ -0,0 +1,208 @@
+#include "benchmark.hpp"
+#include <jsonrpccxx/server.hpp>
+#include <jsonrpccxx/staticserver.hpp>
+
+using namespace jsonrpccxx;
+
+static int add(int a, int b) { return a + b; }
+
+static const std::string addRequest = R"({"jsonrpc":"2.0","id":1,"method":"add","params":[3,4]})";
+
+static void handle(bench::State &state, JsonRpc2Server &server, const std::string &request) {
+  while (state.KeepRunning()) {
+    std::string response = server.HandleRequest(request);
+    bench::DoNotOptimize(response);
+  }
+}
+
+static bool ping() { return true; }
+static void notify(int) {}
+static size_t sum(const std::vector<int> &values) { return values.size(); }
+static std::vector<int> range(int count) {
+  std::vector<int> result(static_cast<size_t>(count));
+  for (int i = 0; i < count; i++)
+    result[static_cast<size_t>(i)] = i;
+  return result;
+}
+
+struct BenchmarkServer {
+  BenchmarkServer() : server() {
+    server.Add("add", GetHandle(&add), {"a", "b"});
+    server.Add("ping", GetHandle(&ping));
+    server.Add("notify", GetHandle(&notify), {"value"});
+    server.Add("sum", GetHandle(&sum), {"values"});
+    server.Add("range", GetHandle(&range), {"count"});
+  }
+  JsonRpc2Server server;
+};
+
+static std::string batch(size_t size) {
+  json request = json::array();
+  for (size_t i = 0; i < size; i++)
+    request.push_back({{"jsonrpc", "2.0"}, {"id", i}, {"method", "add"}, {"params", {i, 1}}});
+  return request.dump();
+}
+
+static void handle_batch(bench::State &state, size_t size) {
+  BenchmarkServer s;
+  handle(state, s.server, batch(size));
+  state.SetItemsProcessed(state.Iterations() * size);
+}
+
+BENCHMARK_CASE("HandleRequest/positional") {
+  BenchmarkServer s;
+  handle(state, s.server, addRequest);
+}
+
+struct NoInstance {};
+static constexpr char addName[] = "add";
+static constexpr char notifyName[] = "notify";
+static constexpr char a[] = "a";
+static constexpr char b[] = "b";
+static constexpr char value[] = "value";
+typedef StaticJsonRpc2Server<NoInstance, Methods<Method<addName, &add, a, b>, Method<notifyName, &notify, value>>> StaticServer;
+
+BENCHMARK_CASE("HandleRequest/static/positional") {
+  NoInstance instance;
+  StaticServer server(instance);
+  handle(state, server, addRequest);
+}
+
+BENCHMARK_CASE("HandleRequest/static/named") {
+  NoInstance instance;
+  StaticServer server(instance);
+  handle(state, server, R"({"jsonrpc":"2.0","id":1,"method":"add","params":{"a":3,"b":4}})");
+}
+
+BENCHMARK_CASE("HandleRequest/named") {
+  BenchmarkServer s;
+  handle(state, s.server, R"({"jsonrpc":"2.0","id":1,"method":"add","params":{"a":3,"b":4}})");
+}
+
+BENCHMARK_CASE("HandleRequest/notification") {
+  BenchmarkServer s;
+  handle(state, s.server, R"({"jsonrpc":"2.0","method":"notify","params":[3]})");
+}
+
+// Small requests are dominated by parsing and checking the envelope
+BENCHMARK_CASE("HandleRequest/notification/async") {
+  BenchmarkServer s;
+  s.server.EnableAsyncNotifications({4096, 1, OverflowPolicy::run_inline});
+  handle(state, s.server, R"({"jsonrpc":"2.0","method":"notify","params":[3]})");
+  s.server.WaitForNotifications();
+}
+
+BENCHMARK_CASE("HandleRequest/small/no_params") {
+  BenchmarkServer s;
+  handle(state, s.server, R"({"jsonrpc":"2.0","id":1,"method":"ping"})");
+}
+
+BENCHMARK_CASE("HandleRequest/small/null_params") {
+  BenchmarkServer s;
+  handle(state, s.server, R"({"jsonrpc":"2.0","id":"a","method":"ping","params":null})");
+}
+
+BENCHMARK_CASE("HandleRequest/small/batch/100") {
+  BenchmarkServer s;
+  json request = json::array();
+  for (size_t i = 0; i < 100; i++)
+    request.push_back({{"jsonrpc", "2.0"}, {"id", i}, {"method", "ping"}});
+  handle(state, s.server, request.dump());
+  state.SetItemsProcessed(state.Iterations() * 100);
+}
+
+BENCHMARK_CASE("HandleRequest/batch/10") { handle_batch(state, 10); }
+BENCHMARK_CASE("HandleRequest/batch/100") { handle_batch(state, 100); }
+BENCHMARK_CASE("HandleRequest/batch/1000") { handle_batch(state, 1000); }
+
+static void handle_on_executor(bench::State &state, const std::string &executor, const std::string &request) {
+  JsonRpc2Server server;
+  MethodOptions options;
+  options.executor = executor;
+  server.Add("add", GetHandle(&add), {"a", "b"}, options);
+  handle(state, server, request);
+}
+
+// Cost of handing a call off to a pool and waiting for it
+BENCHMARK_CASE("HandleRequest/executor/inline") { handle_on_executor(state, "inline", addRequest); }
+BENCHMARK_CASE("HandleRequest/executor/cpu") { handle_on_executor(state, "cpu", addRequest); }
+BENCHMARK_CASE("HandleRequest/executor/cpu/batch/100") {
+  handle_on_executor(state, "cpu", batch(100));
+  state.SetItemsProcessed(state.Iterations() * 100);
+}
+
+BENCHMARK_CASE("HandleRequest/large_params/10000") {
+  BenchmarkServer s;
+  json request = {{"jsonrpc", "2.0"}, {"id", 1}, {"method", "sum"}, {"params", {range(10000)}}};
+  std::string raw = request.dump();
+  handle(state, s.server, raw);
+  state.SetBytesProcessed(state.Iterations() * raw.size());
+}
+
+BENCHMARK_CASE("HandleRequest/large_result/10000") {
+  BenchmarkServer s;
+  handle(state, s.server, R"({"jsonrpc":"2.0","id":1,"method":"range","params":[10000]})");
+}
+
+BENCHMARK_CASE("HandleRequest/error/parse") {
+  BenchmarkServer s;
+  handle(state, s.server, R"({"jsonrpc":"2.0","id":1,"method":"add","params":[3,4)");
+}
+
+BENCHMARK_CASE("HandleRequest/error/invalid_request") {
+  BenchmarkServer s;
+  handle(state, s.server, R"({"jsonrpc":"2.0","id":1,"method":"add","params":3})");
+}
+
+BENCHMARK_CASE("HandleRequest/error/method_not_found") {
+  BenchmarkServer s;
+  handle(state, s.server, R"({"jsonrpc":"2.0","id":1,"method":"unknown","params":[3,4]})");
+}
+
+BENCHMARK_CASE("HandleRequest/error/invalid_params") {
+  BenchmarkServer s;
+  handle(state, s.server, R"({"jsonrpc":"2.0","id":1,"method":"add","params":["3",4]})");
+}
+
+static void forward(RequestContext &, const Next &next) { next(); }
+
+static void intercepted(bench::State &state, size_t count) {
+  JsonRpc2Server server;
+  server.Add("add", GetHandle(&add));
+  for (size_t i = 0; i < count; i++)
+    server.AddInterceptor(&forward);
+  handle(state, server, addRequest);
+}
+
+BENCHMARK_CASE("Interceptors/0") { intercepted(state, 0); }
+BENCHMARK_CASE("Interceptors/1") { intercepted(state, 1); }
+BENCHMARK_CASE("Interceptors/4") { intercepted(state, 4); }
+BENCHMARK_CASE("Interceptors/16") { intercepted(state, 16); }
+
+BENCHMARK_CASE("Interceptors/composed/4") {
+  JsonRpc2Server server;
+  server.Add("add", GetHandle(&add));
+  auto f = [](RequestContext &, const Next &next) { next(); };
+  server.AddInterceptor(ComposeInterceptors(f, f, f, f));
+  handle(state, server, addRequest);
+}
+
+static void chain(bench::State &state, size_t count) {
+  InterceptorChain interceptors;
+  for (size_t i = 0; i < count; i++)
+    interceptors.Add(&forward);
+  std::string method = "add";
+  json id = 1;
+  json params = {3, 4};
+  RequestContext context{method, id, params, false};
+  size_t calls = 0;
+  auto terminal = [&calls]() { calls++; };
+  while (state.KeepRunning()) {
+    interceptors.Run(context, terminal);
+  }
+  bench::DoNotOptimize(calls);
+}
+
+BENCHMARK_CASE("InterceptorChain/Run/1") { chain(state, 1); }
+BENCHMARK_CASE("InterceptorChain/Run/4") { chain(state, 4); }
+BENCHMARK_CASE("InterceptorChain/Run/16") { chain(state, 16); }
@@ -12,13 +12,13 @@ using namespace std;
 
 class WareHouseClient {
 public:
-  explicit WareHouseClient(JsonRpcClient &client) : client(client) {}
-  bool AddProduct(const Product &p) { return client.CallMethod<bool>(1, "AddProduct", {p}); }
-  Product GetProduct(const std::string &id) { return client.CallMethod<Product>(1, "GetProduct", {id}); }
-  vector<Product> AllProducts() { return client.CallMethod<vector<Product>>(1, "AllProducts", {}); }
-
-private:
-  JsonRpcClient &client;
+  explicit WareHouseClient(JsonRpcClient &client)
+      : AddProduct(client.Remote<bool(const Product &)>("AddProduct")),
+        GetProduct(client.Remote<Product(const std::string &)>("GetProduct", {"id"})),
+        AllProducts(client.Remote<vector<Product>()>("AllProducts")) {}
+  RemoteMethod<bool(const Product &)> AddProduct;
+  RemoteMethod<Product(const std::string &)> GetProduct;
+  RemoteMethod<vector<Product>()> AllProducts;
 };
 
 void doWarehouseStuff(IClientConnector &clientConnector) {
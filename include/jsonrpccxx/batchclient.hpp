@@ -1,47 +1,69 @@
 #pragma once
 
 #include "client.hpp"
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace jsonrpccxx {
+  // Calls are serialized into the request buffer as they are added, sending the batch doesn't build a json value
   class BatchRequest {
   public:
-    BatchRequest() : call(json::array()) {}
-    BatchRequest &AddMethodCall(const id_type &id, const std::string &name, const positional_parameter &params = {}) {
-      json request = {{"method", name}, {"params", params}, {"jsonrpc", "2.0"}};
-      if (std::get_if<int>(&id) != nullptr) {
-        request["id"] = std::get<int>(id);
-      } else {
-        request["id"] = std::get<std::string>(id);
-      }
-      call.push_back(request);
+    BatchRequest() : buffer("[]"), count(0), call(json::array()), built(0) {}
+
+    // Reserves buffer space for the serialized calls
+    BatchRequest &Reserve(size_t bytes) {
+      buffer.reserve(bytes + 2);
       return *this;
     }
 
-    BatchRequest &AddNamedMethodCall(const id_type &id, const std::string &name, const named_parameter &params = {}) {
-      json request = {{"method", name}, {"params", params}, {"jsonrpc", "2.0"}};
-      if (std::get_if<int>(&id) != nullptr) {
-        request["id"] = std::get<int>(id);
-      } else {
-        request["id"] = std::get<std::string>(id);
+    BatchRequest &AddMethodCall(const id_type &id, const std::string &name, const positional_parameter &params = {}) { return add(&id, name, params); }
+    BatchRequest &AddNamedMethodCall(const id_type &id, const std::string &name, const named_parameter &params = {}) { return add(&id, name, params); }
+    BatchRequest &AddNotificationCall(const std::string &name, const positional_parameter &params = {}) { return add(nullptr, name, params); }
+    BatchRequest &AddNamedNotificationCall(const std::string &name, const named_parameter &params = {}) { return add(nullptr, name, params); }
+
+    size_t Size() const { return count; }
+
+    // The serialized batch, as sent by BatchClient
+    const std::string &Serialize() const { return buffer; }
+
+    // Parses the serialized calls on demand, only kept for compatibility
+    const json &Build() const {
+      if (built != count) {
+        call = json::parse(Serialize());
+        built = count;
       }
-      call.push_back(request);
-      return *this;
+      return call;
     }
 
-    BatchRequest &AddNotificationCall(const std::string &name, const positional_parameter &params = {}) {
-      call.push_back({{"method", name}, {"params", params}, {"jsonrpc", "2.0"}});
-      return *this;
-    }
+  private:
+    std::string buffer;
+    size_t count;
+    mutable json call;
+    mutable size_t built;
 
-    BatchRequest &AddNamedNotificationCall(const std::string &name, const named_parameter &params = {}) {
-      call.push_back({{"method", name}, {"params", params}, {"jsonrpc", "2.0"}});
+    // Same layout as json::dump() of the request, keys in sorted order
+    template <typename Params>
+    BatchRequest &add(const id_type *id, const std::string &name, const Params &params) {
+      buffer.pop_back();
+      if (count > 0)
+        buffer += ',';
+      buffer += '{';
+      if (id != nullptr) {
+        buffer += "\"id\":";
+        write_id(buffer, *id);
+        buffer += ',';
+      }
+      buffer += "\"jsonrpc\":\"2.0\",\"method\":";
+      write_result(buffer, name);
+      buffer += ",\"params\":";
+      write_params(buffer, params);
+      buffer += "}]";
+      count++;
       return *this;
     }
-
-    const json &Build() const { return call; }
-
-  private:
-    json call;
   };
 
   class BatchResponse {
@@ -83,12 +105,204 @@ namespace jsonrpccxx {
     std::vector<size_t> nullIds;
   };
 
+  // Keeps the raw batch response with an index of its elements, built by a single scan over the bytes without parsing
+  // them. Get<T>() decodes only the element of the requested id, malformed elements are only detected when decoded.
+  class LazyBatchResponse {
+  public:
+    explicit LazyBatchResponse(std::string &&response) : response(std::move(response)), elements(), results(), errors(), nullIds() { index(); }
+
+    template <typename T>
+    T Get(const json &id) const {
+      auto result = results.find(id);
+      if (result != results.end()) {
+        try {
+          return parse_result<T>(begin(result->second), end(result->second));
+        } catch (json::type_error &e) {
+          throw JsonRpcException(parse_error, "invalid return type: " + std::string(e.what()));
+        }
+      }
+      auto error = errors.find(id);
+      if (error != errors.end()) {
+        json element = parse(error->second);
+        throw JsonRpcException::fromJson(element["error"]);
+      }
+      throw JsonRpcException(parse_error, std::string("no result found for id ") + id.dump());
+    }
+
+    bool HasErrors() const { return !errors.empty() || !nullIds.empty(); }
+    const std::vector<size_t> GetInvalidIndexes() const { return nullIds; }
+    size_t Size() const { return elements.size(); }
+    // Parses a single element of the response
+    json GetElement(size_t index) const { return parse(index); }
+    const std::string &GetResponse() const { return response; }
+
+  private:
+    struct Element {
+      size_t begin;
+      size_t end;
+    };
+
+    std::string response;
+    std::vector<Element> elements;
+    std::map<json, size_t> results;
+    std::map<json, size_t> errors;
+    std::vector<size_t> nullIds;
+
+    const char *begin(size_t index) const { return response.data() + elements[index].begin; }
+    const char *end(size_t index) const { return response.data() + elements[index].end; }
+
+    json parse(size_t index) const {
+      try {
+        return json::parse(begin(index), end(index));
+      } catch (json::parse_error &e) {
+        throw JsonRpcException(parse_error, std::string("invalid JSON response from server: ") + e.what());
+      }
+    }
+
+    static JsonRpcException invalid(const std::string &message) { return JsonRpcException(parse_error, "invalid JSON response from server: " + message); }
+
+    static bool whitespace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    // Index of the closing quote of the string starting at begin, memchr skips the string contents in bulk
+    size_t string_end(size_t begin) const {
+      const char *data = response.data();
+      size_t i = begin + 1;
+      while (true) {
+        auto quote = static_cast<const char *>(std::memchr(data + i, '"', response.size() - i));
+        if (quote == nullptr)
+          throw invalid("unterminated string");
+        size_t position = static_cast<size_t>(quote - data);
+        size_t backslashes = 0;
+        while (position - backslashes > begin + 1 && data[position - backslashes - 1] == '\\')
+          backslashes++;
+        if (backslashes % 2 == 0)
+          return position;
+        i = position + 1;
+      }
+    }
+
+    // Tracks the members of each element, keys are only compared at the depth of the element objects
+    void index() {
+      const char *data = response.data();
+      size_t size = response.size();
+      size_t i = 0;
+      while (i < size && whitespace(data[i]))
+        i++;
+      if (i == size || data[i] != '[')
+        throw invalid("expected array");
+      int depth = 0;
+      bool expectKey = false, isObject = false, hasResult = false, hasError = false;
+      size_t elementBegin = 0, valueBegin = 0, idBegin = 0, idEnd = 0;
+      enum { other, id, result, error } key = other;
+      auto finish = [&](size_t elementEnd) {
+        elements.push_back({elementBegin, elementEnd});
+        classify(elements.size() - 1, isObject && idEnd > idBegin, idBegin, idEnd, hasResult, hasError);
+      };
+      for (; i < size; i++) {
+        char c = data[i];
+        if (whitespace(c))
+          continue;
+        if (depth == 1 && c != ',' && c != ']' && c != '{' && c != '[') {
+          // Scalar element
+          elementBegin = i;
+          if (c == '"') {
+            i = string_end(i);
+          } else {
+            while (i + 1 < size && data[i + 1] != ',' && data[i + 1] != ']' && !whitespace(data[i + 1]))
+              i++;
+          }
+          isObject = false;
+          finish(i + 1);
+          continue;
+        }
+        switch (c) {
+        case '"': {
+          size_t end = string_end(i);
+          if (depth == 2 && expectKey) {
+            std::string_view name(data + i + 1, end - i - 1);
+            key = name == "id" ? id : name == "result" ? result : name == "error" ? error : other;
+            hasResult = hasResult || key == result;
+            hasError = hasError || key == error;
+            expectKey = false;
+          }
+          i = end;
+          break;
+        }
+        case '{':
+        case '[':
+          depth++;
+          if (depth == 2) {
+            elementBegin = i;
+            isObject = c == '{';
+            expectKey = isObject;
+            hasResult = hasError = false;
+            idBegin = idEnd = 0;
+            key = other;
+          }
+          break;
+        case ':':
+          if (depth == 2)
+            valueBegin = i + 1;
+          break;
+        case ',':
+          if (depth == 2) {
+            if (key == id) {
+              idBegin = valueBegin;
+              idEnd = i;
+            }
+            expectKey = isObject;
+          }
+          break;
+        case '}':
+        case ']':
+          if (depth == 2) {
+            if (key == id) {
+              idBegin = valueBegin;
+              idEnd = i;
+            }
+            finish(i + 1);
+          }
+          depth--;
+          if (depth == 0) {
+            while (++i < size) {
+              if (!whitespace(data[i]))
+                throw invalid("unexpected data after the batch");
+            }
+            return;
+          }
+          if (depth < 0)
+            throw invalid("unbalanced brackets");
+          break;
+        default:
+          break;
+        }
+      }
+      throw invalid("unexpected end of the batch");
+    }
+
+    void classify(size_t index, bool hasId, size_t idBegin, size_t idEnd, bool hasResult, bool hasError) {
+      json id;
+      if (hasId) {
+        id = json::parse(response.data() + idBegin, response.data() + idEnd, nullptr, false);
+      }
+      if (!(id.is_number() || id.is_string())) {
+        nullIds.push_back(index);
+      } else if (hasResult) {
+        results[id] = index;
+      } else if (hasError) {
+        errors[id] = index;
+      } else {
+        nullIds.push_back(index);
+      }
+    }
+  };
+
   class BatchClient : public JsonRpcClient {
   public:
     explicit BatchClient(IClientConnector &connector) : JsonRpcClient(connector, version::v2) {}
     BatchResponse BatchCall(const BatchRequest &request) {
       try {
-        json response = json::parse(connector.Send(request.Build().dump()));
+        json response = json::parse(connector.Send(request.Serialize()));
         if (!response.is_array()) {
           throw JsonRpcException(parse_error, std::string("invalid JSON response from server: expected array"));
         }
@@ -97,5 +311,7 @@ namespace jsonrpccxx {
         throw JsonRpcException(parse_error, std::string("invalid JSON response from server: ") + e.what());
       }
     }
+    // Only indexes the response, elements are decoded when they are requested
+    LazyBatchResponse LazyBatchCall(const BatchRequest &request) { return LazyBatchResponse(connector.Send(request.Serialize())); }
   };
 }
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "common.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace jsonrpccxx {
+  struct CachePolicy {
+    std::chrono::milliseconds ttl;
+    size_t max_entries;
+  };
+
+  struct CacheStatistics {
+    uint64_t hits;
+    uint64_t misses;
+    size_t entries;
+  };
+
+  inline void to_json(json &j, const CacheStatistics &s) { j = json{{"hits", s.hits}, {"misses", s.misses}, {"entries", s.entries}}; }
+
+  // Serialized results of a single method keyed by its normalized params. Entries are distributed over independently
+  // locked LRU shards by the hash of the params, each shard holds at most max_entries / shard count entries.
+  class ResultCache {
+  public:
+    static constexpr size_t max_shard_count = 8;
+
+    explicit ResultCache(const CachePolicy &policy)
+        : policy(policy), shardCount(std::max<size_t>(1, std::min(max_shard_count, policy.max_entries))), shards(new Shard[shardCount]), hits(0), misses(0) {}
+
+    // Appends the cached result to out, returns false if there is no valid entry
+    bool Get(const json &params, std::string &out) {
+      size_t hash = std::hash<json>{}(params);
+      Shard &shard = shard_for(hash);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto entry = shard.find(hash, params);
+      if (entry != shard.lru.end()) {
+        if (entry->expires > std::chrono::steady_clock::now()) {
+          shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+          out += entry->result;
+          hits.fetch_add(1, std::memory_order_relaxed);
+          return true;
+        }
+        shard.erase(entry);
+      }
+      misses.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    void Put(const json &params, const std::string &result) {
+      size_t hash = std::hash<json>{}(params);
+      Shard &shard = shard_for(hash);
+      auto expires = std::chrono::steady_clock::now() + policy.ttl;
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto entry = shard.find(hash, params);
+      if (entry != shard.lru.end()) {
+        entry->result = result;
+        entry->expires = expires;
+        shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+        return;
+      }
+      shard.lru.push_front(Entry{hash, params, result, expires});
+      shard.index.emplace(hash, shard.lru.begin());
+      if (shard.lru.size() > shard_capacity()) {
+        shard.erase(std::prev(shard.lru.end()));
+      }
+    }
+
+    void Invalidate(const json &params) {
+      size_t hash = std::hash<json>{}(params);
+      Shard &shard = shard_for(hash);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto entry = shard.find(hash, params);
+      if (entry != shard.lru.end())
+        shard.erase(entry);
+    }
+
+    void Clear() {
+      for (size_t i = 0; i < shardCount; i++) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        shards[i].index.clear();
+        shards[i].lru.clear();
+      }
+    }
+
+    CacheStatistics Statistics() const {
+      size_t entries = 0;
+      for (size_t i = 0; i < shardCount; i++) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        entries += shards[i].lru.size();
+      }
+      return CacheStatistics{hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed), entries};
+    }
+
+  private:
+    struct Entry {
+      size_t hash;
+      json params;
+      std::string result;
+      std::chrono::steady_clock::time_point expires;
+    };
+
+    struct Shard {
+      Shard() : mutex(), lru(), index() {}
+      mutable std::mutex mutex;
+      std::list<Entry> lru;
+      std::unordered_multimap<size_t, std::list<Entry>::iterator> index;
+
+      std::list<Entry>::iterator find(size_t hash, const json &params) {
+        auto range = index.equal_range(hash);
+        for (auto i = range.first; i != range.second; ++i) {
+          if (i->second->params == params)
+            return i->second;
+        }
+        return lru.end();
+      }
+
+      void erase(std::list<Entry>::iterator entry) {
+        auto range = index.equal_range(entry->hash);
+        for (auto i = range.first; i != range.second; ++i) {
+          if (i->second == entry) {
+            index.erase(i);
+            break;
+          }
+        }
+        lru.erase(entry);
+      }
+    };
+
+    CachePolicy policy;
+    size_t shardCount;
+    std::unique_ptr<Shard[]> shards;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+
+    Shard &shard_for(size_t hash) { return shards[(hash ^ (hash >> 17)) % shardCount]; }
+    size_t shard_capacity() const { return (policy.max_entries + shardCount - 1) / shardCount; }
+  };
+} // namespace jsonrpccxx
@@ -1,49 +1,317 @@
 #pragma once
 #include "common.hpp"
 #include "iclientconnector.hpp"
+#include "reader.hpp"
+#include "writer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <exception>
+#include <map>
+#include <memory>
 #include <nlohmann/json.hpp>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <variant>
+#include <vector>
 
 namespace jsonrpccxx {
   enum class version { v1, v2 };
   typedef std::vector<json> positional_parameter;
   typedef std::map<std::string, json> named_parameter;
-  typedef std::variant<int, std::string> id_type;
+
+  // String id stored inline up to inline_capacity bytes, which covers UUIDs and most generated ids without allocating
+  class StringId {
+  public:
+    static constexpr size_t inline_capacity = 47;
+
+    StringId() : length(0), buffer(), heap() {}
+    StringId(const char *id) : StringId(std::string_view(id)) {}
+    StringId(const std::string &id) : StringId(std::string_view(id)) {}
+    StringId(std::string_view id) : length(id.size()), buffer(), heap() {
+      if (length <= inline_capacity) {
+        std::memcpy(buffer, id.data(), length);
+      } else {
+        heap.assign(id.data(), length);
+      }
+    }
+
+    std::string_view View() const { return length <= inline_capacity ? std::string_view(buffer, length) : std::string_view(heap); }
+    std::string String() const { return std::string(View()); }
+    bool operator==(const StringId &other) const { return View() == other.View(); }
+    bool operator!=(const StringId &other) const { return View() != other.View(); }
+
+  private:
+    size_t length;
+    char buffer[inline_capacity];
+    std::string heap;
+  };
+  inline void to_json(json &j, const StringId &id) { j = id.String(); }
+
+  typedef std::variant<int64_t, StringId> id_type;
+
+  // Hands out increasing ids, safe to share between threads
+  class IdGenerator {
+  public:
+    IdGenerator() : next(1) {}
+    int64_t Next() { return next.fetch_add(1, std::memory_order_relaxed); }
+
+  private:
+    std::atomic<int64_t> next;
+  };
 
   struct JsonRpcResponse {
     id_type id;
     json result;
   };
 
+  // Decodes the result of a response into T, via SAX if there is a result_reader for T, otherwise from the parsed document
+  template <typename T>
+  inline T parse_result(const char *begin, const char *end) {
+    if constexpr (has_result_reader<T>::value) {
+      ResultSax<T> sax;
+      if (json::sax_parse(begin, end, &sax) && sax.Complete()) {
+        return std::move(sax.Value());
+      }
+    }
+    try {
+      json response = json::parse(begin, end);
+      if (has_key_type(response, "error", json::value_t::object)) {
+        throw JsonRpcException::fromJson(response["error"]);
+      } else if (has_key_type(response, "error", json::value_t::string)) {
+        throw JsonRpcException(internal_error, response["error"]);
+      }
+      auto result = response.find("result");
+      if (result != response.end() && has_key(response, "id")) {
+        if constexpr (std::is_same<T, json>::value) {
+          return std::move(*result);
+        } else {
+          return result->get<T>();
+        }
+      }
+      throw JsonRpcException(internal_error, R"(invalid server response: neither "result" nor "error" fields found)");
+    } catch (json::parse_error &e) {
+      throw JsonRpcException(parse_error, std::string("invalid JSON response from server: ") + e.what());
+    }
+  }
+  template <typename T>
+  inline T parse_result(const std::string &responseString) {
+    return parse_result<T>(responseString.data(), responseString.data() + responseString.size());
+  }
+
+  inline void write_id(std::string &out, const id_type &id) {
+    if (const int64_t *i = std::get_if<int64_t>(&id)) {
+      write_result(out, *i);
+      return;
+    }
+    std::string_view s = std::get<StringId>(id).View();
+    for (char c : s) {
+      // Anything that may need escaping or UTF-8 validation goes through the json serializer
+      if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20 || static_cast<unsigned char>(c) >= 0x80) {
+        write_result(out, std::string(s));
+        return;
+      }
+    }
+    out += '"';
+    out.append(s.data(), s.size());
+    out += '"';
+  }
+
+  // Serialized like a json value of the same params
+  inline void write_params(std::string &out, const positional_parameter &params) {
+    out += '[';
+    for (size_t i = 0; i < params.size(); i++) {
+      if (i > 0)
+        out += ',';
+      write_json(out, params[i]);
+    }
+    out += ']';
+  }
+  inline void write_params(std::string &out, const named_parameter &params) {
+    out += '{';
+    bool first = true;
+    for (auto const &p : params) {
+      if (!first)
+        out += ',';
+      first = false;
+      write_result(out, p.first);
+      out += ':';
+      write_json(out, p.second);
+    }
+    out += '}';
+  }
+
+  // Request of a single method with the envelope serialized once, only the params and the id are replaced per request
+  class RequestBuffer {
+  public:
+    RequestBuffer(version v, const std::string &name) : v(v), buffer(), prefix(0) {
+      buffer = v == version::v2 ? R"({"jsonrpc":"2.0","method":)" : R"({"method":)";
+      write_result(buffer, name);
+      buffer += ",\"params\":";
+      prefix = buffer.size();
+    }
+
+    // Discards the previous request, the params are appended to the returned buffer
+    std::string &Params() {
+      buffer.resize(prefix);
+      return buffer;
+    }
+    const std::string &Method(const id_type &id) {
+      buffer += ",\"id\":";
+      write_id(buffer, id);
+      buffer += '}';
+      return buffer;
+    }
+    const std::string &Notification() {
+      if (v == version::v1) {
+        buffer += ",\"id\":null";
+      }
+      buffer += '}';
+      return buffer;
+    }
+
+  private:
+    version v;
+    std::string buffer;
+    size_t prefix;
+  };
+
+  // Calls a single method with the request envelope serialized once, each call only appends the params and the id to the
+  // reused buffer. Not thread-safe, use one prepared call per thread.
+  class PreparedCall {
+  public:
+    PreparedCall(IClientConnector &connector, version v, const std::string &name) : connector(connector), request(v, name) {}
+
+    template <typename T>
+    T Call(const id_type &id, const positional_parameter &params = {}) {
+      write_params(request.Params(), params);
+      return parse_result<T>(connector.Send(request.Method(id)));
+    }
+    template <typename T>
+    T CallNamed(const id_type &id, const named_parameter &params = {}) {
+      write_params(request.Params(), params);
+      return parse_result<T>(connector.Send(request.Method(id)));
+    }
+
+    void Notify(const positional_parameter &params = {}) {
+      write_params(request.Params(), params);
+      connector.Send(request.Notification());
+    }
+    void NotifyNamed(const named_parameter &params = {}) {
+      write_params(request.Params(), params);
+      connector.Send(request.Notification());
+    }
+
+  private:
+    IClientConnector &connector;
+    RequestBuffer request;
+  };
+
+  // Typed proxy of a remote method declared by its signature, e.g. RemoteMethod<Product(const std::string &)>. Arguments
+  // are serialized straight into the request without intermediate json values and the result is decoded into ReturnType.
+  // With param names the arguments are sent by name. Methods returning void are sent as notifications.
+  // Ids are taken from the IdGenerator of the client, standalone proxies have their own. Not thread-safe, use one proxy per
+  // thread.
+  template <typename Signature>
+  class RemoteMethod;
+
+  template <typename ReturnType, typename... ParamTypes>
+  class RemoteMethod<ReturnType(ParamTypes...)> {
+  public:
+    RemoteMethod(IClientConnector &connector, version v, const std::string &name, const std::vector<std::string> &paramNames = {},
+                 std::shared_ptr<IdGenerator> ids = std::make_shared<IdGenerator>())
+        : connector(connector), request(v, name), names(), ids(std::move(ids)) {
+      if (!paramNames.empty() && paramNames.size() != sizeof...(ParamTypes)) {
+        throw std::invalid_argument("expected " + std::to_string(sizeof...(ParamTypes)) + " param names for method " + name);
+      }
+      for (auto const &n : paramNames) {
+        std::string key;
+        write_result(key, n);
+        names.push_back(key + ':');
+      }
+    }
+
+    ReturnType operator()(const typename std::decay<ParamTypes>::type &... params) {
+      write_params(params...);
+      if constexpr (std::is_void<ReturnType>::value) {
+        connector.Send(request.Notification());
+      } else {
+        return parse_result<ReturnType>(connector.Send(request.Method(ids->Next())));
+      }
+    }
+
+  private:
+    IClientConnector &connector;
+    RequestBuffer request;
+    // Serialized keys including the colon
+    std::vector<std::string> names;
+    std::shared_ptr<IdGenerator> ids;
+
+    void write_params(const typename std::decay<ParamTypes>::type &... params) {
+      std::string &out = request.Params();
+      out += names.empty() ? '[' : '{';
+      [[maybe_unused]] size_t index = 0;
+      (write_param(out, index++, params), ...);
+      out += names.empty() ? ']' : '}';
+    }
+
+    template <typename T>
+    void write_param(std::string &out, size_t index, const T &value) {
+      if (index > 0)
+        out += ',';
+      if (!names.empty())
+        out += names[index];
+      write_result(out, value);
+    }
+  };
+
   class JsonRpcClient {
   public:
-    JsonRpcClient(IClientConnector &connector, version v) : connector(connector), v(v) {}
+    JsonRpcClient(IClientConnector &connector, version v) : connector(connector), v(v), ids(std::make_shared<IdGenerator>()), timeout() {}
     virtual ~JsonRpcClient() = default;
 
     template <typename T>
-    T CallMethod(const id_type &id, const std::string &name) { return call_method(id, name, json::object()).result.get<T>(); }
-     template <typename T>
-    T CallMethod(const id_type &id, const std::string &name, const positional_parameter &params) { return call_method(id, name, params).result.get<T>(); }
+    T CallMethod(const id_type &id, const std::string &name) { return parse_result<T>(call_method(id, name, json::object())); }
     template <typename T>
-    T CallMethodNamed(const id_type &id, const std::string &name, const named_parameter &params = {}) { return call_method(id, name, params).result.get<T>(); }
+    T CallMethod(const id_type &id, const std::string &name, const positional_parameter &params) { return parse_result<T>(call_method(id, name, params)); }
+    template <typename T>
+    T CallMethodNamed(const id_type &id, const std::string &name, const named_parameter &params = {}) { return parse_result<T>(call_method(id, name, params)); }
 
     void CallNotification(const std::string &name, const positional_parameter &params = {}) { call_notification(name, params); }
     void CallNotificationNamed(const std::string &name, const named_parameter &params = {}) { call_notification(name, params); }
 
+    // Unique id for callers that don't care about id values, e.g. CallMethod<int>(client.NextId(), "add", {1, 2})
+    int64_t NextId() { return ids->Next(); }
+
+    // Sent as "timeout" member with method calls, servers don't start calls still queued when it has passed
+    void SetTimeout(std::optional<std::chrono::milliseconds> t) { timeout = t; }
+
+    // Prepared calls and proxies refer to the connector of this client, proxies share its id generator
+    PreparedCall Prepare(const std::string &name) { return PreparedCall(connector, v, name); }
+    template <typename Signature>
+    RemoteMethod<Signature> Remote(const std::string &name, const std::vector<std::string> &paramNames = {}) {
+      return RemoteMethod<Signature>(connector, v, name, paramNames, ids);
+    }
+
   protected:
     IClientConnector &connector;
 
   private:
     version v;
+    std::shared_ptr<IdGenerator> ids;
+    std::optional<std::chrono::milliseconds> timeout;
 
-    JsonRpcResponse call_method(const id_type &id, const std::string &name, const json &params) {
+    // Returns the raw response
+    std::string call_method(const id_type &id, const std::string &name, const json &params) {
       json j = {{"method", name}};
-      if (std::get_if<int>(&id) != nullptr) {
-        j["id"] = std::get<int>(id);
+      if (const int64_t *i = std::get_if<int64_t>(&id)) {
+        j["id"] = *i;
       } else {
-        j["id"] = std::get<std::string>(id);
+        j["id"] = std::get<StringId>(id);
       }
       if (v == version::v2) {
         j["jsonrpc"] = "2.0";
@@ -55,23 +323,10 @@ namespace jsonrpccxx {
       } else if (v == version::v1) {
         j["params"] = nullptr;
       }
-      try {
-        json response = json::parse(connector.Send(j.dump()));
-        if (has_key_type(response, "error", json::value_t::object)) {
-          throw JsonRpcException::fromJson(response["error"]);
-        } else if (has_key_type(response, "error", json::value_t::string)) {
-          throw JsonRpcException(internal_error, response["error"]);
-        }
-        if (has_key(response, "result") && has_key(response, "id")) {
-          if (response["id"].type() == json::value_t::string)
-            return JsonRpcResponse{response["id"].get<std::string>(), response["result"].get<json>()};
-          else
-            return JsonRpcResponse{response["id"].get<int>(), response["result"].get<json>()};
-        }
-        throw JsonRpcException(internal_error, R"(invalid server response: neither "result" nor "error" fields found)");
-      } catch (json::parse_error &e) {
-        throw JsonRpcException(parse_error, std::string("invalid JSON response from server: ") + e.what());
+      if (timeout) {
+        j["timeout"] = timeout->count();
       }
+      return connector.Send(j.dump());
     }
 
     void call_notification(const std::string &name, const nlohmann::json &params) {
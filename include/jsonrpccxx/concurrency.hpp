@@ -0,0 +1,102 @@
+#pragma once
+
+#include "common.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+namespace jsonrpccxx {
+  struct ConcurrencyLimit {
+    size_t max_in_flight;
+    // Calls exceeding max_in_flight wait for a free slot, as long as no more than max_queued calls are waiting already
+    size_t max_queued = 0;
+    std::chrono::milliseconds queue_timeout = std::chrono::milliseconds(100);
+    // Rejected calls fail with this code, should be a server error (-32000 to -32099)
+    int error_code = -32000;
+  };
+
+  // Admission control for a single method. The in-flight count is maintained with lock-free compare-and-swap,
+  // only calls that have to wait for a slot fall back to a mutex and condition variable.
+  class ConcurrencyLimiter {
+  public:
+    explicit ConcurrencyLimiter(const ConcurrencyLimit &limit) : limit(limit), inFlight(0), queued(0), rejected(0), mutex(), released() {}
+
+    bool TryAcquire() {
+      size_t current = inFlight.load();
+      while (current < limit.max_in_flight) {
+        if (inFlight.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed))
+          return true;
+      }
+      return false;
+    }
+
+    bool Acquire() {
+      if (TryAcquire())
+        return true;
+      if (enqueue()) {
+        bool acquired;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          acquired = released.wait_for(lock, limit.queue_timeout, [this]() { return TryAcquire(); });
+        }
+        queued.fetch_sub(1);
+        if (acquired)
+          return true;
+      }
+      rejected.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    void Release() {
+      inFlight.fetch_sub(1);
+      if (queued.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        released.notify_one();
+      }
+    }
+
+    const ConcurrencyLimit &Limit() const { return limit; }
+    size_t InFlight() const { return inFlight.load(std::memory_order_relaxed); }
+    size_t Queued() const { return queued.load(std::memory_order_relaxed); }
+    uint64_t Rejected() const { return rejected.load(std::memory_order_relaxed); }
+
+  private:
+    ConcurrencyLimit limit;
+    std::atomic<size_t> inFlight;
+    std::atomic<size_t> queued;
+    std::atomic<uint64_t> rejected;
+    std::mutex mutex;
+    std::condition_variable released;
+
+    bool enqueue() {
+      size_t current = queued.load(std::memory_order_relaxed);
+      while (current < limit.max_queued) {
+        if (queued.compare_exchange_weak(current, current + 1))
+          return true;
+      }
+      return false;
+    }
+  };
+
+  // Holds a slot of a limiter for the duration of a call, throws if the call is not admitted. Does nothing without limiter.
+  class AdmissionGuard {
+  public:
+    AdmissionGuard(ConcurrencyLimiter *limiter, const std::string &name) : limiter(limiter) {
+      if (limiter != nullptr && !limiter->Acquire()) {
+        throw JsonRpcException(limiter->Limit().error_code, "server busy: too many concurrent calls to " + name);
+      }
+    }
+    AdmissionGuard(const AdmissionGuard &) = delete;
+    AdmissionGuard &operator=(const AdmissionGuard &) = delete;
+    ~AdmissionGuard() {
+      if (limiter != nullptr)
+        limiter->Release();
+    }
+
+  private:
+    ConcurrencyLimiter *limiter;
+  };
+} // namespace jsonrpccxx
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "common.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace jsonrpccxx {
+  // Error code of calls rejected or cancelled because their deadline passed
+  static constexpr int deadline_exceeded = -32001;
+
+  typedef std::chrono::steady_clock DeadlineClock;
+
+  // Tells a handler whether its caller is still waiting for the result. Handlers receive it by declaring a
+  // CancellationToken as their last param, which is not taken from the request params, or via Current(). Copies share
+  // their state, a token without deadline is never cancelled unless Cancel() is called.
+  class CancellationToken {
+  public:
+    CancellationToken() : state() {}
+    explicit CancellationToken(DeadlineClock::time_point deadline) : state(std::make_shared<State>(deadline)) {}
+
+    bool IsCancelled() const {
+      return state != nullptr && (state->cancelled.load(std::memory_order_relaxed) || DeadlineClock::now() >= state->deadline);
+    }
+    // time_point::max() without deadline
+    DeadlineClock::time_point Deadline() const { return state != nullptr ? state->deadline : DeadlineClock::time_point::max(); }
+    DeadlineClock::duration Remaining() const {
+      if (state == nullptr)
+        return DeadlineClock::duration::max();
+      return std::max(state->deadline - DeadlineClock::now(), DeadlineClock::duration::zero());
+    }
+    void Cancel() const {
+      if (state != nullptr)
+        state->cancelled.store(true, std::memory_order_relaxed);
+    }
+    void ThrowIfCancelled() const {
+      if (IsCancelled())
+        throw JsonRpcException(deadline_exceeded, "deadline exceeded");
+    }
+
+    // Token of the call running on the current thread
+    static const CancellationToken &Current() {
+      const CancellationToken *token = current();
+      static const CancellationToken none;
+      return token != nullptr ? *token : none;
+    }
+
+  private:
+    friend class CancellationScope;
+
+    struct State {
+      explicit State(DeadlineClock::time_point deadline) : cancelled(false), deadline(deadline) {}
+      std::atomic<bool> cancelled;
+      DeadlineClock::time_point deadline;
+    };
+    std::shared_ptr<State> state;
+
+    static const CancellationToken *&current() {
+      thread_local const CancellationToken *token = nullptr;
+      return token;
+    }
+  };
+
+  // Makes a token for the deadline current while a call runs, no token is allocated for calls without deadline
+  class CancellationScope {
+  public:
+    explicit CancellationScope(DeadlineClock::time_point deadline)
+        : token(deadline != DeadlineClock::time_point::max() ? CancellationToken(deadline) : CancellationToken()), previous(CancellationToken::current()) {
+      CancellationToken::current() = &token;
+    }
+    CancellationScope(const CancellationScope &) = delete;
+    CancellationScope &operator=(const CancellationScope &) = delete;
+    ~CancellationScope() { CancellationToken::current() = previous; }
+
+  private:
+    CancellationToken token;
+    const CancellationToken *previous;
+  };
+
+  // Arrival and client supplied deadline of the request handled on the current thread. Deadlines of methods are counted
+  // from the arrival, so time spent queued counts against them.
+  struct RequestTiming {
+    DeadlineClock::time_point arrival;
+    DeadlineClock::time_point deadline;
+
+    bool Known() const { return arrival != DeadlineClock::time_point(); }
+
+    static RequestTiming &Current() {
+      thread_local RequestTiming timing{DeadlineClock::time_point(), DeadlineClock::time_point::max()};
+      return timing;
+    }
+  };
+
+  class RequestTimingScope {
+  public:
+    explicit RequestTimingScope(const RequestTiming &timing) : previous(RequestTiming::Current()) { RequestTiming::Current() = timing; }
+    RequestTimingScope(const RequestTimingScope &) = delete;
+    RequestTimingScope &operator=(const RequestTimingScope &) = delete;
+    ~RequestTimingScope() { RequestTiming::Current() = previous; }
+
+  private:
+    RequestTiming previous;
+  };
+} // namespace jsonrpccxx
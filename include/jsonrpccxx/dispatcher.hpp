@@ -1,8 +1,19 @@
 #pragma once
 
+#include "cache.hpp"
 #include "common.hpp"
+#include "concurrency.hpp"
+#include "deadline.hpp"
+#include "executor.hpp"
+#include "schema.hpp"
+#include "singleflight.hpp"
+#include "statistics.hpp"
 #include "typemapper.hpp"
+#include <algorithm>
 #include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
 
 namespace jsonrpccxx {
@@ -10,33 +21,74 @@ namespace jsonrpccxx {
   typedef std::vector<std::string> NamedParamMapping;
   static NamedParamMapping NAMED_PARAM_MAPPING;
 
+  struct MethodOptions {
+    MethodOptions() : concurrency(), cache(), single_flight(false), contract(), executor(), deadline() {}
+    std::optional<ConcurrencyLimit> concurrency;
+    // Results of methods with a cache policy are cached by their params, only use for idempotent methods
+    std::optional<CachePolicy> cache;
+    // Concurrent calls with identical params share a single execution, only use for idempotent methods
+    bool single_flight;
+    // JSON schema of each positional param, params are validated against it before they are converted
+    std::vector<json> contract;
+    // Name of the executor calls are handed off to, see Dispatcher::AddExecutor(). Calls run on the calling thread if empty.
+    std::string executor;
+    // Time a call may take from the arrival of its request, overrides the default deadline of the dispatcher
+    std::optional<std::chrono::milliseconds> deadline;
+  };
+
   class Dispatcher {
   public:
     Dispatcher() :
       methods(),
       notifications(),
-      mapping() {}
+      mapping(),
+      statistics(),
+      collectStatistics(false),
+      limiters(),
+      caches(),
+      flights(),
+      contracts(),
+      executors(),
+      methodExecutors(),
+      defaultDeadline(),
+      deadlines(),
+      discoveryInfo(),
+      discoveryDocument() {}
 
-    bool Add(const std::string &name, MethodHandle callback, const NamedParamMapping &mapping = NAMED_PARAM_MAPPING) {
+    bool Add(const std::string &name, MethodHandle callback, const NamedParamMapping &mapping = NAMED_PARAM_MAPPING, const MethodOptions &options = {}) {
       if (contains(name))
         return false;
+      add_options(name, mapping, options);
       methods[name] = std::move(callback);
-      if (!mapping.empty()) {
-        this->mapping[name] = mapping;
-      }
+      update_discovery();
       return true;
     }
 
-    bool Add(const std::string &name, NotificationHandle callback, const NamedParamMapping &mapping = NAMED_PARAM_MAPPING) {
+    bool Add(const std::string &name, NotificationHandle callback, const NamedParamMapping &mapping = NAMED_PARAM_MAPPING, const MethodOptions &options = {}) {
       if (contains(name))
         return false;
+      add_options(name, mapping, options);
       notifications[name] = std::move(callback);
-      if (!mapping.empty()) {
-        this->mapping[name] = mapping;
-      }
+      update_discovery();
       return true;
     }
 
+    // Registers an executor methods can be routed to by name. The names "inline", "cpu" and "blocking" refer to an
+    // InlineExecutor, MakeCpuPool() and MakeBlockingPool() unless registered otherwise, pools are started on first use.
+    void AddExecutor(const std::string &name, std::shared_ptr<Executor> executor) { executors[name] = std::move(executor); }
+    // Executor of a method, null if it runs on the calling thread
+    Executor *FindExecutor(const std::string &name) const {
+      if (methodExecutors.empty())
+        return nullptr;
+      auto e = methodExecutors.find(name);
+      return e != methodExecutors.end() ? e->second : nullptr;
+    }
+
+    // Deadline of calls to methods without their own, calls still queued when it passes are rejected with deadline_exceeded.
+    // Must be set before serving requests.
+    void SetDefaultDeadline(std::optional<std::chrono::milliseconds> deadline) { defaultDeadline = deadline; }
+    bool HasDeadlines() const { return defaultDeadline.has_value() || !deadlines.empty(); }
+
     JsonRpcException process_type_error(const std::string &name, JsonRpcException &e) {
       if (e.Code() == -32602 && !e.Data().empty()) {
         std::string message = e.Message() + " for parameter ";
@@ -50,53 +102,380 @@ namespace jsonrpccxx {
       return e;
     }
 
-    json InvokeMethod(const std::string &name, const json &params) {
+    json InvokeMethod(const std::string &name, const json &params) { return invoke_method(name, params); }
+    // Arguments may be moved out of params
+    json InvokeMethod(const std::string &name, json &&params) { return invoke_method(name, std::move(params)); }
+
+    // Appends the serialized result to out, cached or shared results are appended without invoking the method
+    void InvokeMethod(const std::string &name, const json &params, std::string &out) { invoke_method(name, params, out); }
+    void InvokeMethod(const std::string &name, json &&params, std::string &out) { invoke_method(name, std::move(params), out); }
+
+    void InvokeNotification(const std::string &name, const json &params) { invoke_notification(name, params); }
+    void InvokeNotification(const std::string &name, json &&params) { invoke_notification(name, std::move(params)); }
+
+    // Statistics are collected for all methods and notifications, must be enabled before serving requests
+    void EnableStatistics() {
+      collectStatistics = true;
+      for (auto const &m : methods) {
+        if (statistics.find(m.first) == statistics.end())
+          statistics[m.first] = std::make_unique<MethodStatistics>();
+      }
+      for (auto const &n : notifications) {
+        if (statistics.find(n.first) == statistics.end())
+          statistics[n.first] = std::make_unique<MethodStatistics>();
+      }
+    }
+
+    std::map<std::string, MethodStatisticsSnapshot> GetStatistics() const {
+      std::map<std::string, MethodStatisticsSnapshot> result;
+      for (auto const &s : statistics) {
+        result[s.first] = s.second->Snapshot();
+      }
+      return result;
+    }
+
+    void ResetStatistics() {
+      for (auto const &s : statistics) {
+        s.second->Reset();
+      }
+    }
+
+    std::map<std::string, CacheStatistics> GetCacheStatistics() const {
+      std::map<std::string, CacheStatistics> result;
+      for (auto const &c : caches) {
+        result[c.first] = c.second->Statistics();
+      }
+      return result;
+    }
+
+    bool InvalidateCache(const std::string &name) {
+      ResultCache *cache = find_cache(name);
+      if (cache == nullptr)
+        return false;
+      cache->Clear();
+      return true;
+    }
+
+    bool InvalidateCache(const std::string &name, const json &params) {
+      ResultCache *cache = find_cache(name);
+      if (cache == nullptr)
+        return false;
+      cache->Invalidate(normalize_parameter(name, params, methods[name].OptionalParams()));
+      return true;
+    }
+
+    void InvalidateCaches() {
+      for (auto const &c : caches) {
+        c.second->Clear();
+      }
+    }
+
+    // OpenRPC method objects of all methods and notifications, reserved methods are left out. Param schemas are taken from
+    // the contract if there is one, otherwise from the param types of the handle.
+    json Describe() const {
+      json result = json::array();
+      for (auto const &m : methods) {
+        describe(m.first, m.second, false, result);
+      }
+      for (auto const &n : notifications) {
+        describe(n.first, n.second, true, result);
+      }
+      return result;
+    }
+
+    // The serialized OpenRPC document is rebuilt whenever a method is added, serving it only copies the bytes
+    void EnableDiscovery(const json &info) {
+      discoveryInfo = info;
+      update_discovery();
+    }
+    const std::string &DiscoveryDocument() const { return discoveryDocument; }
+
+  private:
+    std::map<std::string, MethodHandle> methods;
+    std::map<std::string, NotificationHandle> notifications;
+    std::map<std::string, NamedParamMapping> mapping;
+    std::map<std::string, std::unique_ptr<MethodStatistics>> statistics;
+    bool collectStatistics;
+    std::map<std::string, std::unique_ptr<ConcurrencyLimiter>> limiters;
+    std::map<std::string, std::unique_ptr<ResultCache>> caches;
+    std::map<std::string, std::unique_ptr<SingleFlight>> flights;
+    std::map<std::string, std::vector<Schema>> contracts;
+    std::map<std::string, std::shared_ptr<Executor>> executors;
+    std::map<std::string, Executor *> methodExecutors;
+    std::optional<std::chrono::milliseconds> defaultDeadline;
+    std::map<std::string, std::chrono::milliseconds> deadlines;
+    json discoveryInfo;
+    std::string discoveryDocument;
+
+    template <typename Handle>
+    void describe(const std::string &name, const Handle &handle, bool notification, json &result) const {
+      if (name.rfind("rpc.", 0) == 0)
+        return;
+      json types = handle.Describe();
+      auto names = mapping.find(name);
+      const std::vector<Schema> *contract = find_contract(name);
+      size_t count = types.is_null() ? 0 : types["params"].size();
+      count = std::max(count, names != mapping.end() ? names->second.size() : 0);
+      count = std::max(count, contract != nullptr ? contract->size() : 0);
+      size_t required = types.is_null() ? 0 : count - handle.OptionalParams();
+      json params = json::array();
+      for (size_t i = 0; i < count; i++) {
+        json param = {{"name", names != mapping.end() && i < names->second.size() ? names->second[i] : std::to_string(i)}, {"schema", json::object()}};
+        if (contract != nullptr && i < contract->size()) {
+          param["schema"] = (*contract)[i].Document();
+        } else if (!types.is_null() && i < types["params"].size()) {
+          param["schema"] = types["params"][i];
+        }
+        param["required"] = i < required;
+        params.push_back(std::move(param));
+      }
+      json method = {{"name", name}, {"params", std::move(params)}, {"paramStructure", names != mapping.end() ? "either" : "by-position"}};
+      if (!notification) {
+        method["result"] = {{"name", "result"}, {"schema", !types.is_null() && has_key(types, "result") ? types["result"] : json::object()}};
+      }
+      result.push_back(std::move(method));
+    }
+
+    void update_discovery() {
+      if (discoveryInfo.is_null())
+        return;
+      discoveryDocument = json{{"openrpc", "1.3.2"}, {"info", discoveryInfo}, {"methods", Describe()}}.dump();
+    }
+
+    void add_options(const std::string &name, const NamedParamMapping &mapping, const MethodOptions &options) {
+      // Compiled and looked up first, an invalid contract or unknown executor throws before anything is registered
+      std::vector<Schema> contract(options.contract.begin(), options.contract.end());
+      Executor *executor = options.executor.empty() ? nullptr : find_or_create_executor(options.executor);
+      if (!mapping.empty()) {
+        this->mapping[name] = mapping;
+      }
+      if (collectStatistics) {
+        statistics[name] = std::make_unique<MethodStatistics>();
+      }
+      if (options.concurrency) {
+        limiters[name] = std::make_unique<ConcurrencyLimiter>(*options.concurrency);
+      }
+      if (options.cache) {
+        caches[name] = std::make_unique<ResultCache>(*options.cache);
+      }
+      if (options.single_flight) {
+        flights[name] = std::make_unique<SingleFlight>();
+      }
+      if (!contract.empty()) {
+        contracts[name] = std::move(contract);
+      }
+      if (executor != nullptr) {
+        methodExecutors[name] = executor;
+      }
+      if (options.deadline) {
+        deadlines[name] = *options.deadline;
+      }
+    }
+
+    Executor *find_or_create_executor(const std::string &name) {
+      auto e = executors.find(name);
+      if (e != executors.end())
+        return e->second.get();
+      std::shared_ptr<Executor> executor;
+      if (name == "inline") {
+        executor = std::make_shared<InlineExecutor>();
+      } else if (name == "cpu") {
+        executor = MakeCpuPool();
+      } else if (name == "blocking") {
+        executor = MakeBlockingPool();
+      } else {
+        throw std::invalid_argument("unknown executor " + name);
+      }
+      executors[name] = executor;
+      return executor.get();
+    }
+
+    template <typename Params>
+    json invoke_method(const std::string &name, Params &&params) {
       auto method = methods.find(name);
       if (method == methods.end()) {
         throw JsonRpcException(method_not_found, "method not found: " + name);
       }
-      try {
-        return method->second(normalize_parameter(name, params));
-      } catch (json::type_error &e) {
-        throw JsonRpcException(invalid_params, "invalid parameter: " + std::string(e.what()));
-      } catch (JsonRpcException &e) {
-        throw process_type_error(name, e);
+      if (find_cache(name) != nullptr || find_flight(name) != nullptr) {
+        std::string result;
+        invoke_method(name, std::forward<Params>(params), result);
+        return json::parse(result);
+      }
+      return invoke(name, method->second.OptionalParams(), std::forward<Params>(params), [&method](json &&p) { return method->second(std::move(p)); });
+    }
+
+    template <typename Params>
+    void invoke_method(const std::string &name, Params &&params, std::string &out) {
+      auto method = methods.find(name);
+      if (method == methods.end()) {
+        throw JsonRpcException(method_not_found, "method not found: " + name);
+      }
+      ResultCache *cache = find_cache(name);
+      SingleFlight *flight = find_flight(name);
+      if (cache == nullptr && flight == nullptr) {
+        invoke(name, method->second.OptionalParams(), std::forward<Params>(params), [&method, &out](json &&p) { method->second.Write(std::move(p), out); });
+        return;
+      }
+      json normalized = normalize_parameter(name, std::forward<Params>(params), method->second.OptionalParams());
+      if (cache != nullptr && cache->Get(normalized, out)) {
+        return;
+      }
+      // normalized is kept as cache and flight key, the method gets a copy
+      auto execute = [this, &name, &method, &normalized, cache](std::string &result) {
+        std::string serialized;
+        invoke(name, 0, normalized, [&method, &serialized](json &&p) { method->second.Write(std::move(p), serialized); });
+        if (cache != nullptr) {
+          cache->Put(normalized, serialized);
+        }
+        result += serialized;
+      };
+      if (flight != nullptr) {
+        flight->Do(normalized, out, execute);
+      } else {
+        execute(out);
       }
     }
 
-    void InvokeNotification(const std::string &name, const json &params) {
+    template <typename Params>
+    void invoke_notification(const std::string &name, Params &&params) {
       auto notification = notifications.find(name);
       if (notification == notifications.end()) {
         throw JsonRpcException(method_not_found, "notification not found: " + name);
       }
+      invoke(name, notification->second.OptionalParams(), std::forward<Params>(params), [&notification](json &&p) { notification->second(std::move(p)); });
+    }
+
+    // call always gets the normalized params as rvalue, they are either a copy or moved from the caller's params
+    template <typename Params, typename Call>
+    auto invoke(const std::string &name, size_t optional, Params &&params, Call &&call) -> decltype(call(json())) {
+      StatisticsScope scope(find_statistics(name));
       try {
-        notification->second(normalize_parameter(name, params));
+        DeadlineClock::time_point deadline = deadline_of(name);
+        AdmissionGuard admission(find_limiter(name), name);
+        check_deadline(deadline, name);
+        json normalized = normalize_parameter(name, std::forward<Params>(params), optional);
+        if (const std::vector<Schema> *contract = find_contract(name)) {
+          validate_contract(*contract, normalized);
+        }
+        if (Executor *executor = FindExecutor(name)) {
+          return RunOn(*executor, [&call, &normalized, &name, deadline]() {
+            check_deadline(deadline, name);
+            CancellationScope token(deadline);
+            return call(std::move(normalized));
+          });
+        }
+        CancellationScope token(deadline);
+        return call(std::move(normalized));
       } catch (json::type_error &e) {
+        scope.Fail(invalid_params);
         throw JsonRpcException(invalid_params, "invalid parameter: " + std::string(e.what()));
       } catch (JsonRpcException &e) {
+        scope.Fail(e.Code());
         throw process_type_error(name, e);
+      } catch (...) {
+        scope.Fail(internal_error);
+        throw;
       }
     }
 
-  private:
-    std::map<std::string, MethodHandle> methods;
-    std::map<std::string, NotificationHandle> notifications;
-    std::map<std::string, NamedParamMapping> mapping;
+    // The earlier of the client supplied deadline and the deadline of the method, time_point::max() if there is none
+    DeadlineClock::time_point deadline_of(const std::string &name) const {
+      const RequestTiming &timing = RequestTiming::Current();
+      if (!HasDeadlines())
+        return timing.deadline;
+      std::optional<std::chrono::milliseconds> timeout = defaultDeadline;
+      if (!deadlines.empty()) {
+        auto d = deadlines.find(name);
+        if (d != deadlines.end())
+          timeout = d->second;
+      }
+      if (!timeout)
+        return timing.deadline;
+      DeadlineClock::time_point arrival = timing.Known() ? timing.arrival : DeadlineClock::now();
+      return std::min(timing.deadline, arrival + *timeout);
+    }
+
+    static void check_deadline(DeadlineClock::time_point deadline, const std::string &name) {
+      if (deadline != DeadlineClock::time_point::max() && DeadlineClock::now() >= deadline)
+        throw JsonRpcException(deadline_exceeded, "deadline exceeded before calling " + name);
+    }
+
+    inline ResultCache *find_cache(const std::string &name) {
+      if (caches.empty())
+        return nullptr;
+      auto c = caches.find(name);
+      return c != caches.end() ? c->second.get() : nullptr;
+    }
+
+    inline SingleFlight *find_flight(const std::string &name) {
+      if (flights.empty())
+        return nullptr;
+      auto f = flights.find(name);
+      return f != flights.end() ? f->second.get() : nullptr;
+    }
+
+    inline ConcurrencyLimiter *find_limiter(const std::string &name) {
+      if (limiters.empty())
+        return nullptr;
+      auto l = limiters.find(name);
+      return l != limiters.end() ? l->second.get() : nullptr;
+    }
+
+    inline const std::vector<Schema> *find_contract(const std::string &name) const {
+      if (contracts.empty())
+        return nullptr;
+      auto c = contracts.find(name);
+      return c != contracts.end() ? &c->second : nullptr;
+    }
+
+    // Missing or surplus params are left to the handle, which reports them like without a contract
+    static void validate_contract(const std::vector<Schema> &contract, const json &params) {
+      std::string error;
+      for (size_t i = 0; i < contract.size() && i < params.size(); i++) {
+        if (!contract[i].Validate(params[i], error)) {
+          throw JsonRpcException(invalid_params, "invalid parameter: " + error, i);
+        }
+      }
+    }
 
+    inline MethodStatistics *find_statistics(const std::string &name) {
+      if (!collectStatistics)
+        return nullptr;
+      auto s = statistics.find(name);
+      return s != statistics.end() ? s->second.get() : nullptr;
+    }
+    static bool omitted(const json &params, const NamedParamMapping &names, size_t from) {
+      for (size_t i = from; i < names.size(); i++) {
+        if (params.find(names[i]) != params.end())
+          return false;
+      }
+      return true;
+    }
     inline bool contains(const std::string &name) { return (methods.find(name) != methods.end() || notifications.find(name) != notifications.end()); }
-    inline json normalize_parameter(const std::string &name, const json &params) {
+    // Omitted trailing named params are left out of the result if the handle declares them optional
+    template <typename Params>
+    inline json normalize_parameter(const std::string &name, Params &&params, size_t optional = 0) {
       if (params.type() == json::value_t::array) {
-        return params;
+        return std::forward<Params>(params);
       } else if (params.type() == json::value_t::object) {
         if (mapping.find(name) == mapping.end()) {
           throw JsonRpcException(invalid_params, "invalid parameter: procedure doesn't support named parameter");
         }
-        json result;
-        for (auto const &p : mapping[name]) {
-          if (params.find(p) == params.end()) {
-            throw JsonRpcException(invalid_params, "invalid parameter: missing named parameter \"" + p + "\"");
+        const NamedParamMapping &names = mapping[name];
+        json result = json::array();
+        for (size_t i = 0; i < names.size(); i++) {
+          auto value = params.find(names[i]);
+          if (value == params.end()) {
+            if (i + optional < names.size() || !omitted(params, names, i)) {
+              throw JsonRpcException(invalid_params, "invalid parameter: missing named parameter \"" + names[i] + "\"");
+            }
+            break;
+          }
+          if constexpr (std::is_lvalue_reference<Params>::value) {
+            result.push_back(*value);
+          } else {
+            result.push_back(std::move(*value));
           }
-          result.push_back(params[p]);
         }
         return result;
       }
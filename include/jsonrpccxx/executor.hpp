@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jsonrpccxx {
+  // Runs the calls of methods routed to it via MethodOptions::executor
+  class Executor {
+  public:
+    typedef std::function<void()> Task;
+
+    virtual ~Executor() = default;
+    virtual void Execute(Task task) = 0;
+    // Calls made from the current thread are run directly instead of being queued behind the caller
+    virtual bool RunsDirectly() const { return current() == this; }
+
+  protected:
+    static const Executor *&current() {
+      thread_local const Executor *executor = nullptr;
+      return executor;
+    }
+  };
+
+  class InlineExecutor : public Executor {
+  public:
+    void Execute(Task task) override { task(); }
+    bool RunsDirectly() const override { return true; }
+  };
+
+  struct ThreadPoolOptions {
+    // Threads are started on demand up to max_threads, threads above min_threads exit after being idle for keep_alive
+    size_t min_threads;
+    size_t max_threads;
+    std::chrono::milliseconds keep_alive = std::chrono::seconds(60);
+  };
+
+  // Work-stealing pool: every worker has its own queue, idle workers take queued tasks from the others. Tasks are spread
+  // over the queues round-robin, tasks submitted by a worker go to its own queue. Queued tasks are run before the pool
+  // is destroyed, exceptions thrown by tasks are ignored.
+  class ThreadPool : public Executor {
+  public:
+    explicit ThreadPool(const ThreadPoolOptions &options)
+        : options(normalized(options)), slots(), next(0), queued(0), mutex(), wake(), threads(0), idle(0), wakeups(0), stopping(false) {
+      for (size_t i = 0; i < this->options.max_threads; i++)
+        slots.push_back(std::make_unique<Slot>());
+      std::lock_guard<std::mutex> lock(mutex);
+      for (size_t i = 0; i < this->options.min_threads; i++)
+        spawn();
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool() override {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      wake.notify_all();
+      for (auto &s : slots) {
+        if (s->thread.joinable())
+          s->thread.join();
+      }
+    }
+
+    void Execute(Task task) override {
+      size_t index = current() == this ? worker_index() : next.fetch_add(1, std::memory_order_relaxed) % slots.size();
+      {
+        std::lock_guard<std::mutex> lock(slots[index]->mutex);
+        slots[index]->tasks.push_back(std::move(task));
+      }
+      queued.fetch_add(1);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (idle > wakeups) {
+        wakeups++;
+        wake.notify_one();
+      } else if (threads < options.max_threads) {
+        spawn();
+      }
+    }
+
+    size_t Threads() const {
+      std::lock_guard<std::mutex> lock(mutex);
+      return threads;
+    }
+    size_t Queued() const { return queued.load(std::memory_order_relaxed); }
+    const ThreadPoolOptions &Options() const { return options; }
+
+  private:
+    struct Slot {
+      Slot() : mutex(), tasks(), thread(), active(false) {}
+      std::mutex mutex;
+      std::deque<Task> tasks;
+      std::thread thread;
+      bool active;
+    };
+
+    ThreadPoolOptions options;
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::atomic<size_t> next;
+    std::atomic<size_t> queued;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    size_t threads;
+    size_t idle;
+    // Idle workers that were notified but haven't woken up yet
+    size_t wakeups;
+    bool stopping;
+
+    static ThreadPoolOptions normalized(ThreadPoolOptions options) {
+      options.max_threads = std::max<size_t>(options.max_threads, 1);
+      options.min_threads = std::min(options.min_threads, options.max_threads);
+      return options;
+    }
+
+    static size_t &worker_index() {
+      thread_local size_t index = 0;
+      return index;
+    }
+
+    // Called with mutex held
+    void spawn() {
+      for (size_t i = 0; i < slots.size(); i++) {
+        Slot &slot = *slots[i];
+        if (slot.active)
+          continue;
+        // A worker that exited after its keep-alive has released the mutex before returning
+        if (slot.thread.joinable())
+          slot.thread.join();
+        try {
+          slot.thread = std::thread([this, i]() { work(i); });
+        } catch (std::system_error &) {
+          // Queued tasks are still run by the running workers
+          if (threads > 0)
+            return;
+          throw;
+        }
+        slot.active = true;
+        threads++;
+        return;
+      }
+    }
+
+    bool take(size_t index, Task &task) {
+      if (queued.load() == 0)
+        return false;
+      for (size_t n = 0; n < slots.size(); n++) {
+        Slot &slot = *slots[(index + n) % slots.size()];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if (!slot.tasks.empty()) {
+          task = std::move(slot.tasks.front());
+          slot.tasks.pop_front();
+          queued.fetch_sub(1);
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void work(size_t index) {
+      current() = this;
+      worker_index() = index;
+      Task task;
+      while (true) {
+        if (take(index, task)) {
+          try {
+            task();
+          } catch (...) {
+          }
+          task = nullptr;
+          continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        // Execute() increments queued before taking the mutex, so a task queued after this check notifies this worker
+        if (queued.load() > 0)
+          continue;
+        if (stopping) {
+          threads--;
+          return;
+        }
+        idle++;
+        auto woken = [this]() { return stopping || wakeups > 0; };
+        bool notified = true;
+        if (threads > options.min_threads) {
+          notified = wake.wait_for(lock, options.keep_alive, woken);
+        } else {
+          wake.wait(lock, woken);
+        }
+        idle--;
+        if (wakeups > 0) {
+          wakeups--;
+        } else if (!notified && !stopping) {
+          slots[index]->active = false;
+          threads--;
+          return;
+        }
+      }
+    }
+  };
+
+  // Pool sized to the cores of the machine, for CPU-bound methods
+  inline std::shared_ptr<Executor> MakeCpuPool(size_t threads = std::thread::hardware_concurrency()) {
+    threads = std::max<size_t>(threads, 1);
+    return std::make_shared<ThreadPool>(ThreadPoolOptions{threads, threads});
+  }
+
+  // Elastic pool for methods blocking on I/O, grows with the number of concurrent calls up to max_threads
+  inline std::shared_ptr<Executor> MakeBlockingPool(size_t max_threads = 64, std::chrono::milliseconds keep_alive = std::chrono::seconds(60)) {
+    return std::make_shared<ThreadPool>(ThreadPoolOptions{0, max_threads, keep_alive});
+  }
+
+  // Runs f on executor and waits for it, exceptions are rethrown to the caller
+  template <typename F>
+  auto RunOn(Executor &executor, F &&f) -> decltype(f()) {
+    typedef decltype(f()) Result;
+    if (executor.RunsDirectly())
+      return f();
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = false;
+    std::exception_ptr error;
+    typename std::conditional<std::is_void<Result>::value, bool, std::optional<Result>>::type result{};
+    executor.Execute([&]() {
+      try {
+        if constexpr (std::is_void<Result>::value) {
+          f();
+        } else {
+          result.emplace(f());
+        }
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      done = true;
+      finished.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&done]() { return done; });
+    if (error)
+      std::rethrow_exception(error);
+    if constexpr (!std::is_void<Result>::value)
+      return std::move(*result);
+  }
+} // namespace jsonrpccxx
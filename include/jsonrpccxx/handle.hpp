@@ -0,0 +1,203 @@
+#pragma once
+
+#include "common.hpp"
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace jsonrpccxx {
+  // Type-erased callable invoked with the request params. Small callables, such as the bindings created by GetHandle(),
+  // are stored inline, so a call is a single indirect call without nested std::function objects or heap allocation.
+  template <typename ReturnType>
+  class BasicHandle {
+  public:
+    BasicHandle() noexcept : operations(nullptr), storage() {}
+    BasicHandle(std::nullptr_t) noexcept : BasicHandle() {}
+
+    template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, BasicHandle>::value &&
+                                                             std::is_invocable_r<ReturnType, typename std::decay<F>::type &, const json &>::value>::type>
+    BasicHandle(F &&f) : operations(operations_for<typename std::decay<F>::type>()), storage() {
+      typedef typename std::decay<F>::type Callable;
+      if constexpr (stored_inline<Callable>()) {
+        new (storage.buffer) Callable(std::forward<F>(f));
+      } else {
+        storage.heap = new Callable(std::forward<F>(f));
+      }
+    }
+
+    BasicHandle(const BasicHandle &other) : operations(other.operations), storage() {
+      if (operations != nullptr)
+        operations->copy(other.storage, storage);
+    }
+    BasicHandle(BasicHandle &&other) noexcept : operations(other.operations), storage() {
+      if (operations != nullptr) {
+        operations->move(other.storage, storage);
+        other.operations = nullptr;
+      }
+    }
+    BasicHandle &operator=(const BasicHandle &other) {
+      if (this != &other) {
+        BasicHandle copy(other);
+        *this = std::move(copy);
+      }
+      return *this;
+    }
+    BasicHandle &operator=(BasicHandle &&other) noexcept {
+      if (this != &other) {
+        reset();
+        if (other.operations != nullptr) {
+          other.operations->move(other.storage, storage);
+          operations = other.operations;
+          other.operations = nullptr;
+        }
+      }
+      return *this;
+    }
+    ~BasicHandle() { reset(); }
+
+    ReturnType operator()(const json &params) const {
+      if (operations == nullptr)
+        throw std::bad_function_call();
+      return operations->invoke(storage, params);
+    }
+    // The callable may move arguments out of params
+    ReturnType operator()(json &&params) const {
+      if (operations == nullptr)
+        throw std::bad_function_call();
+      return operations->invoke_owned(storage, params);
+    }
+    // Appends the serialized result to out, callables providing Write(params, out) serialize it themselves
+    void Write(const json &params, std::string &out) const {
+      if (operations == nullptr)
+        throw std::bad_function_call();
+      operations->write(storage, params, out);
+    }
+    void Write(json &&params, std::string &out) const {
+      if (operations == nullptr)
+        throw std::bad_function_call();
+      operations->write_owned(storage, params, out);
+    }
+    // Number of trailing params the callable declares as optional
+    size_t OptionalParams() const noexcept { return operations != nullptr ? operations->optional_params : 0; }
+    // Param and result schemas if the callable provides a static Describe(), null otherwise
+    json Describe() const { return operations != nullptr && operations->describe != nullptr ? operations->describe() : json(); }
+    explicit operator bool() const noexcept { return operations != nullptr; }
+
+  private:
+    union Storage {
+      Storage() : heap(nullptr) {}
+      void *heap;
+      alignas(std::max_align_t) unsigned char buffer[4 * sizeof(void *)];
+    };
+
+    struct Operations {
+      ReturnType (*invoke)(Storage &, const json &);
+      ReturnType (*invoke_owned)(Storage &, json &);
+      void (*write)(Storage &, const json &, std::string &);
+      void (*write_owned)(Storage &, json &, std::string &);
+      void (*copy)(const Storage &, Storage &);
+      void (*move)(Storage &, Storage &);
+      void (*destroy)(Storage &);
+      size_t optional_params;
+      json (*describe)();
+    };
+
+    const Operations *operations;
+    mutable Storage storage;
+
+    template <typename F>
+    static constexpr bool stored_inline() {
+      return sizeof(F) <= sizeof(Storage) && alignof(F) <= alignof(Storage) && std::is_nothrow_move_constructible<F>::value;
+    }
+
+    template <typename F>
+    static F &target(Storage &s) {
+      if constexpr (stored_inline<F>()) {
+        return *std::launder(reinterpret_cast<F *>(s.buffer));
+      } else {
+        return *static_cast<F *>(s.heap);
+      }
+    }
+    template <typename F>
+    static const F &target(const Storage &s) {
+      return target<F>(const_cast<Storage &>(s));
+    }
+
+    template <typename F, typename = void>
+    struct has_write : std::false_type {};
+    template <typename F>
+    struct has_write<F, std::void_t<decltype(std::declval<const F &>().Write(std::declval<const json &>(), std::declval<std::string &>()))>> : std::true_type {};
+
+    template <typename F, typename = void>
+    struct optional_params_of : std::integral_constant<size_t, 0> {};
+    template <typename F>
+    struct optional_params_of<F, std::void_t<decltype(F::optional_params)>> : std::integral_constant<size_t, F::optional_params> {};
+
+    template <typename F, typename = void>
+    struct describe_of {
+      static constexpr json (*value)() = nullptr;
+    };
+    template <typename F>
+    struct describe_of<F, std::void_t<decltype(F::Describe())>> {
+      static constexpr json (*value)() = &F::Describe;
+    };
+
+    template <typename F, typename Params>
+    static void write(F &f, Params &&params, std::string &out) {
+      if constexpr (has_write<F>::value) {
+        f.Write(std::forward<Params>(params), out);
+      } else if constexpr (std::is_void<ReturnType>::value) {
+        f(std::forward<Params>(params));
+      } else {
+        out += json(f(std::forward<Params>(params))).dump();
+      }
+    }
+
+    template <typename F>
+    static const Operations *operations_for() {
+      static const Operations o{[](Storage &s, const json &params) -> ReturnType { return target<F>(s)(params); },
+                                [](Storage &s, json &params) -> ReturnType { return target<F>(s)(std::move(params)); },
+                                [](Storage &s, const json &params, std::string &out) { write<F>(target<F>(s), params, out); },
+                                [](Storage &s, json &params, std::string &out) { write<F>(target<F>(s), std::move(params), out); },
+                                [](const Storage &from, Storage &to) {
+                                  if constexpr (stored_inline<F>()) {
+                                    new (to.buffer) F(target<F>(from));
+                                  } else {
+                                    to.heap = new F(target<F>(from));
+                                  }
+                                },
+                                [](Storage &from, Storage &to) {
+                                  if constexpr (stored_inline<F>()) {
+                                    new (to.buffer) F(std::move(target<F>(from)));
+                                    target<F>(from).~F();
+                                  } else {
+                                    to.heap = from.heap;
+                                    from.heap = nullptr;
+                                  }
+                                },
+                                [](Storage &s) {
+                                  if constexpr (stored_inline<F>()) {
+                                    target<F>(s).~F();
+                                  } else {
+                                    delete static_cast<F *>(s.heap);
+                                  }
+                                },
+                                optional_params_of<F>::value,
+                                describe_of<F>::value};
+      return &o;
+    }
+
+    void reset() noexcept {
+      if (operations != nullptr) {
+        operations->destroy(storage);
+        operations = nullptr;
+      }
+    }
+  };
+
+  typedef BasicHandle<json> MethodHandle;
+  typedef BasicHandle<void> NotificationHandle;
+} // namespace jsonrpccxx
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "common.hpp"
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jsonrpccxx {
+  // Request as seen by interceptors, params may be modified before they are passed to the dispatcher
+  struct RequestContext {
+    const std::string &method;
+    const json &id;
+    json &params;
+    bool notification;
+  };
+
+  // Non-owning reference to the remainder of an interceptor chain
+  class Next {
+  public:
+    template <typename F>
+    explicit Next(F &f) : object(&f), call([](void *o) { (*static_cast<F *>(o))(); }) {}
+    Next(const Next &) = delete;
+    Next &operator=(const Next &) = delete;
+
+    void operator()() const { call(object); }
+
+  private:
+    void *object;
+    void (*call)(void *);
+  };
+
+  // Interceptors run around dispatching, they may reject a call by throwing a JsonRpcException instead of calling next()
+  typedef std::function<void(RequestContext &, const Next &)> Interceptor;
+
+  class InterceptorChain {
+  public:
+    InterceptorChain() : interceptors() {}
+
+    void Add(Interceptor interceptor) { interceptors.push_back(std::move(interceptor)); }
+    bool Empty() const { return interceptors.empty(); }
+    size_t Size() const { return interceptors.size(); }
+
+    template <typename Terminal>
+    void Run(RequestContext &context, Terminal &terminal) const {
+      Next next(terminal);
+      run(0, context, next);
+    }
+
+  private:
+    std::vector<Interceptor> interceptors;
+
+    void run(size_t index, RequestContext &context, const Next &terminal) const {
+      if (index == interceptors.size()) {
+        terminal();
+        return;
+      }
+      auto rest = [this, index, &context, &terminal]() { run(index + 1, context, terminal); };
+      interceptors[index](context, Next(rest));
+    }
+  };
+
+  // Composes interceptors at compile time into a single one, so a static chain costs only one indirect call
+  template <typename Last>
+  auto ComposeInterceptors(Last last) {
+    return last;
+  }
+
+  template <typename First, typename Second, typename... Rest>
+  auto ComposeInterceptors(First first, Second second, Rest... rest) {
+    return [first = std::move(first), tail = ComposeInterceptors(std::move(second), std::move(rest)...)](RequestContext &context, const Next &next) {
+      auto remainder = [&tail, &context, &next]() { tail(context, next); };
+      first(context, Next(remainder));
+    };
+  }
+} // namespace jsonrpccxx
@@ -0,0 +1,300 @@
+#pragma once
+
+#include "common.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jsonrpccxx {
+  // Bounded multi-producer multi-consumer ring buffer. Each cell carries a sequence number telling producers and
+  // consumers whose turn it is, so push and pop are a single compare-and-swap without locks. Capacity is rounded up to
+  // a power of two of at least 2, with a single cell a full and a free cell would carry the same sequence.
+  template <typename T>
+  class BoundedQueue {
+  public:
+    explicit BoundedQueue(size_t capacity) : cells(round_up(capacity)), mask(cells.size() - 1), head(0), tail(0) {
+      for (size_t i = 0; i < cells.size(); i++)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Moves from value only if there is room
+    bool TryPush(T &value) {
+      size_t position = tail.load(std::memory_order_relaxed);
+      while (true) {
+        Cell &cell = cells[position & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence == position) {
+          if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+            cell.value = std::move(value);
+            cell.sequence.store(position + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (sequence < position) {
+          return false;
+        } else {
+          position = tail.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    bool TryPop(T &value) {
+      size_t position = head.load(std::memory_order_relaxed);
+      while (true) {
+        Cell &cell = cells[position & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence == position + 1) {
+          if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+            value = std::move(cell.value);
+            cell.value = T();
+            cell.sequence.store(position + cells.size(), std::memory_order_release);
+            return true;
+          }
+        } else if (sequence < position + 1) {
+          return false;
+        } else {
+          position = head.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    // Approximate while producers or consumers are active
+    size_t Size() const {
+      size_t h = head.load(std::memory_order_relaxed);
+      size_t t = tail.load(std::memory_order_relaxed);
+      return t > h ? t - h : 0;
+    }
+    size_t Capacity() const { return cells.size(); }
+
+  private:
+    struct Cell {
+      Cell() : sequence(0), value() {}
+      std::atomic<size_t> sequence;
+      T value;
+    };
+
+    std::vector<Cell> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+
+    static size_t round_up(size_t capacity) {
+      size_t result = 2;
+      while (result < capacity)
+        result <<= 1;
+      return result;
+    }
+  };
+
+  // What Submit() does with a task while the queue is full
+  enum class OverflowPolicy { drop, block, run_inline };
+
+  struct NotificationQueueOptions {
+    size_t capacity = 1024;
+    size_t workers = 1;
+    OverflowPolicy overflow = OverflowPolicy::drop;
+  };
+
+  struct NotificationQueueStatistics {
+    // Tasks waiting for a worker
+    size_t depth;
+    size_t max_depth;
+    uint64_t enqueued;
+    uint64_t dropped;
+    uint64_t ran_inline;
+    // Tasks run by workers, including failed ones
+    uint64_t completed;
+    uint64_t failed;
+  };
+
+  inline void to_json(json &j, const NotificationQueueStatistics &s) {
+    j = json{{"depth", s.depth},         {"max_depth", s.max_depth}, {"enqueued", s.enqueued}, {"dropped", s.dropped},
+             {"ran_inline", s.ran_inline}, {"completed", s.completed}, {"failed", s.failed}};
+  }
+
+  // Runs tasks on a fixed pool of worker threads. Producers and workers only take the mutex to sleep or to wake sleepers,
+  // queued tasks are run before the queue is destroyed. Exceptions thrown by tasks are counted and otherwise ignored.
+  class NotificationQueue {
+  public:
+    typedef std::function<void()> Task;
+
+    explicit NotificationQueue(const NotificationQueueOptions &options)
+        : options(options),
+          tasks(std::max<size_t>(options.capacity, 1)),
+          mutex(),
+          available(),
+          space(),
+          idle(),
+          sleeping(0),
+          blocked(0),
+          pending(0),
+          stopping(false),
+          maxDepth(0),
+          enqueued(0),
+          dropped(0),
+          ranInline(0),
+          completed(0),
+          failed(0),
+          workers() {
+      for (size_t i = 0; i < std::max<size_t>(options.workers, 1); i++)
+        workers.emplace_back([this]() { work(); });
+    }
+    NotificationQueue(const NotificationQueue &) = delete;
+    NotificationQueue &operator=(const NotificationQueue &) = delete;
+    ~NotificationQueue() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      available.notify_all();
+      space.notify_all();
+      for (auto &w : workers)
+        w.join();
+    }
+
+    // Returns false if the task was dropped because the queue is full
+    bool Submit(Task task) {
+      pending.fetch_add(1);
+      if (tasks.TryPush(task)) {
+        queued();
+        return true;
+      }
+      switch (options.overflow) {
+      case OverflowPolicy::block:
+        push_blocking(task);
+        return true;
+      case OverflowPolicy::run_inline:
+        run_inline(task);
+        return true;
+      default:
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        finish();
+        return false;
+      }
+    }
+
+    // Blocks until all submitted tasks have run
+    void Drain() {
+      std::unique_lock<std::mutex> lock(mutex);
+      idle.wait(lock, [this]() { return pending.load() == 0; });
+    }
+
+    NotificationQueueStatistics Statistics() const {
+      return {tasks.Size(),
+              maxDepth.load(std::memory_order_relaxed),
+              enqueued.load(std::memory_order_relaxed),
+              dropped.load(std::memory_order_relaxed),
+              ranInline.load(std::memory_order_relaxed),
+              completed.load(std::memory_order_relaxed),
+              failed.load(std::memory_order_relaxed)};
+    }
+    const NotificationQueueOptions &Options() const { return options; }
+
+  private:
+    NotificationQueueOptions options;
+    BoundedQueue<Task> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    std::condition_variable space;
+    std::condition_variable idle;
+    std::atomic<size_t> sleeping;
+    std::atomic<size_t> blocked;
+    // Submitted tasks that haven't finished yet
+    std::atomic<size_t> pending;
+    bool stopping;
+    std::atomic<size_t> maxDepth;
+    std::atomic<uint64_t> enqueued;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> ranInline;
+    std::atomic<uint64_t> completed;
+    std::atomic<uint64_t> failed;
+    std::vector<std::thread> workers;
+
+    void queued() {
+      enqueued.fetch_add(1, std::memory_order_relaxed);
+      size_t depth = tasks.Size();
+      size_t seen = maxDepth.load(std::memory_order_relaxed);
+      while (depth > seen && !maxDepth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+      }
+      wake(sleeping, available, false);
+    }
+
+    // Waits for a worker to make room, the task is run inline if the queue is stopped meanwhile
+    void push_blocking(Task &task) {
+      std::unique_lock<std::mutex> lock(mutex);
+      blocked.fetch_add(1);
+      // Pairs with the fence in wake(): either the worker sees the blocked producer or the producer sees the free cell
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      bool pushed = false;
+      while (!(pushed = tasks.TryPush(task)) && !stopping)
+        space.wait(lock);
+      blocked.fetch_sub(1);
+      lock.unlock();
+      if (pushed) {
+        queued();
+      } else {
+        run_inline(task);
+      }
+    }
+
+    void run_inline(Task &task) {
+      ranInline.fetch_add(1, std::memory_order_relaxed);
+      try {
+        task();
+      } catch (...) {
+      }
+      finish();
+    }
+
+    void work() {
+      Task task;
+      while (true) {
+        if (!tasks.TryPop(task)) {
+          std::unique_lock<std::mutex> lock(mutex);
+          sleeping.fetch_add(1);
+          // Pairs with the fence in wake(): either the producer sees the sleeper or the sleeper sees the task
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          bool popped = false;
+          while (!(popped = tasks.TryPop(task)) && !stopping)
+            available.wait(lock);
+          sleeping.fetch_sub(1);
+          if (!popped)
+            return;
+        }
+        wake(blocked, space, true);
+        try {
+          task();
+        } catch (...) {
+          failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        task = nullptr;
+        completed.fetch_add(1, std::memory_order_relaxed);
+        finish();
+      }
+    }
+
+    void wake(std::atomic<size_t> &waiters, std::condition_variable &condition, bool all) {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiters.load(std::memory_order_relaxed) == 0)
+        return;
+      std::lock_guard<std::mutex> lock(mutex);
+      if (all) {
+        condition.notify_all();
+      } else {
+        condition.notify_one();
+      }
+    }
+
+    void finish() {
+      if (pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.notify_all();
+      }
+    }
+  };
+} // namespace jsonrpccxx
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "common.hpp"
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jsonrpccxx {
+  // Decodes results straight from the SAX events of the response, without building a json value. Readers exist for bool,
+  // arithmetic types, std::string and vectors of these. An event a reader doesn't accept returns false, the response is
+  // then decoded via the DOM, so conversions and error messages are the same as with json::get<T>().
+  template <typename T, typename = void>
+  struct result_reader;
+
+  template <typename T, typename = void>
+  struct has_result_reader : std::false_type {};
+  template <typename T>
+  struct has_result_reader<T, std::void_t<decltype(sizeof(result_reader<T>))>> : std::true_type {};
+
+  struct scalar_reader {
+    scalar_reader() : done(false) {}
+    bool done;
+
+    bool boolean(bool) { return false; }
+    bool number_integer(json::number_integer_t) { return false; }
+    bool number_unsigned(json::number_unsigned_t) { return false; }
+    bool number_float(json::number_float_t) { return false; }
+    bool string(json::string_t &) { return false; }
+    bool start_array() { return false; }
+    bool end_array() { return false; }
+    bool Active() const { return false; }
+    bool Complete() const { return done; }
+    void Reset() { done = false; }
+  };
+
+  template <>
+  struct result_reader<bool> : scalar_reader {
+    result_reader() : scalar_reader(), value(false) {}
+    bool value;
+    bool boolean(bool v) {
+      value = v;
+      done = true;
+      return true;
+    }
+  };
+
+  template <typename T>
+  struct result_reader<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> : scalar_reader {
+    result_reader() : scalar_reader(), value() {}
+    T value;
+    bool number_integer(json::number_integer_t v) { return set(static_cast<T>(v)); }
+    bool number_unsigned(json::number_unsigned_t v) { return set(static_cast<T>(v)); }
+
+  private:
+    bool set(T v) {
+      value = v;
+      done = true;
+      return true;
+    }
+  };
+
+  template <typename T>
+  struct result_reader<T, typename std::enable_if<std::is_floating_point<T>::value>::type> : scalar_reader {
+    result_reader() : scalar_reader(), value() {}
+    T value;
+    bool number_integer(json::number_integer_t v) { return set(static_cast<T>(v)); }
+    bool number_unsigned(json::number_unsigned_t v) { return set(static_cast<T>(v)); }
+    bool number_float(json::number_float_t v) { return set(static_cast<T>(v)); }
+
+  private:
+    bool set(T v) {
+      value = v;
+      done = true;
+      return true;
+    }
+  };
+
+  template <>
+  struct result_reader<std::string> : scalar_reader {
+    result_reader() : scalar_reader(), value() {}
+    std::string value;
+    bool string(json::string_t &v) {
+      value = std::move(v);
+      done = true;
+      return true;
+    }
+  };
+
+  template <typename T>
+  struct result_reader<std::vector<T>, typename std::enable_if<has_result_reader<T>::value>::type> {
+    result_reader() : value(), element(), state(before) {}
+    std::vector<T> value;
+
+    bool boolean(bool v) { return state == inside && element.boolean(v) && take(); }
+    bool number_integer(json::number_integer_t v) { return state == inside && element.number_integer(v) && take(); }
+    bool number_unsigned(json::number_unsigned_t v) { return state == inside && element.number_unsigned(v) && take(); }
+    bool number_float(json::number_float_t v) { return state == inside && element.number_float(v) && take(); }
+    bool string(json::string_t &v) { return state == inside && element.string(v) && take(); }
+    bool start_array() {
+      if (state == before) {
+        state = inside;
+        return true;
+      }
+      return state == inside && element.start_array();
+    }
+    bool end_array() {
+      if (state != inside)
+        return false;
+      if (!element.Active()) {
+        state = after;
+        return true;
+      }
+      return element.end_array() && take();
+    }
+    bool Active() const { return state == inside; }
+    bool Complete() const { return state == after; }
+    void Reset() {
+      value.clear();
+      state = before;
+    }
+
+  private:
+    enum { before, inside, after };
+    result_reader<T> element;
+    int state;
+
+    bool take() {
+      if (element.Complete()) {
+        value.push_back(std::move(element.value));
+        element.Reset();
+      }
+      return true;
+    }
+  };
+
+  // SAX handler of a single response, passes the events of "result" to the reader. Any "error" member, a missing "id" or
+  // a result the reader doesn't accept stops the parser, so the response is handled by the DOM path instead.
+  template <typename T>
+  class ResultSax {
+  public:
+    ResultSax() : reader(), depth(0), inResult(false), hasId(false), hasResult(false) {}
+
+    bool Complete() const { return hasId && hasResult && reader.Complete(); }
+    T &Value() { return reader.value; }
+
+    bool null() { return !inResult && depth > 0; }
+    bool boolean(bool v) { return inResult ? reader.boolean(v) : depth > 0; }
+    bool number_integer(json::number_integer_t v) { return inResult ? reader.number_integer(v) : depth > 0; }
+    bool number_unsigned(json::number_unsigned_t v) { return inResult ? reader.number_unsigned(v) : depth > 0; }
+    bool number_float(json::number_float_t v, const json::string_t &) { return inResult ? reader.number_float(v) : depth > 0; }
+    bool string(json::string_t &v) { return inResult ? reader.string(v) : depth > 0; }
+    bool binary(json::binary_t &) { return false; }
+    bool start_object(std::size_t) {
+      if (inResult)
+        return false;
+      depth++;
+      return true;
+    }
+    bool key(json::string_t &k) {
+      if (depth != 1)
+        return true;
+      if (k == "error")
+        return false;
+      hasId = hasId || k == "id";
+      inResult = k == "result";
+      hasResult = hasResult || inResult;
+      return true;
+    }
+    bool end_object() {
+      depth--;
+      return true;
+    }
+    bool start_array(std::size_t) {
+      if (inResult)
+        return reader.start_array();
+      depth++;
+      return depth > 1;
+    }
+    bool end_array() {
+      if (inResult)
+        return reader.end_array();
+      depth--;
+      return true;
+    }
+    bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) { return false; }
+
+  private:
+    result_reader<T> reader;
+    int depth;
+    bool inResult;
+    bool hasId;
+    bool hasResult;
+  };
+} // namespace jsonrpccxx
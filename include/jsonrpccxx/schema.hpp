@@ -0,0 +1,357 @@
+#pragma once
+
+#include "common.hpp"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jsonrpccxx {
+  // Subset of JSON Schema compiled into a flat list of nodes, so validation is a single pass over the value without
+  // looking up keywords. Supported keywords: type, properties, required, additionalProperties (boolean), items (a single
+  // schema), minimum, maximum, exclusiveMinimum, exclusiveMaximum, minLength, maxLength, minItems and maxItems.
+  // Other keywords, e.g. description, are kept in the document but not validated.
+  class Schema {
+  public:
+    // Accepts any value
+    Schema() : document(json::object()), nodes(1), properties(), required() {}
+    // Throws std::invalid_argument if a supported keyword has an invalid value
+    explicit Schema(const json &schema) : document(schema), nodes(), properties(), required() { compile(schema); }
+
+    const json &Document() const { return document; }
+
+    // Returns false and describes the first violation in error, e.g. "must be >= 0 at /items/1/count"
+    bool Validate(const json &value, std::string &error) const {
+      std::string path;
+      if (validate(0, value, error, path))
+        return true;
+      if (!path.empty()) {
+        error += " at " + path;
+      }
+      return false;
+    }
+
+  private:
+    enum : uint8_t {
+      type_null = 1,
+      type_boolean = 2,
+      type_integer = 4,
+      type_number = 8,
+      type_string = 16,
+      type_array = 32,
+      type_object = 64,
+      type_any = 127,
+    };
+    enum : uint8_t { check_range = 1, check_length = 2, check_items = 4, check_properties = 8 };
+
+    struct Node {
+      Node()
+          : types(type_any),
+            checks(0),
+            exclusive_minimum(false),
+            exclusive_maximum(false),
+            additional_properties(true),
+            minimum(-std::numeric_limits<double>::infinity()),
+            maximum(std::numeric_limits<double>::infinity()),
+            min_length(0),
+            max_length(std::numeric_limits<size_t>::max()),
+            min_items(0),
+            max_items(std::numeric_limits<size_t>::max()),
+            items(0),
+            properties_begin(0),
+            properties_end(0),
+            required_begin(0),
+            required_end(0) {}
+      uint8_t types;
+      uint8_t checks;
+      bool exclusive_minimum;
+      bool exclusive_maximum;
+      bool additional_properties;
+      double minimum;
+      double maximum;
+      // Code points of strings
+      size_t min_length;
+      size_t max_length;
+      size_t min_items;
+      size_t max_items;
+      // Node of the array elements, 0 if unconstrained
+      size_t items;
+      size_t properties_begin;
+      size_t properties_end;
+      size_t required_begin;
+      size_t required_end;
+    };
+
+    json document;
+    std::vector<Node> nodes;
+    std::vector<std::pair<std::string, size_t>> properties;
+    std::vector<std::string> required;
+
+    static uint8_t parse_type(const json &name) {
+      static const std::pair<const char *, uint8_t> names[] = {{"null", type_null},     {"boolean", type_boolean}, {"integer", type_integer},
+                                                               {"number", type_number | type_integer}, {"string", type_string}, {"array", type_array},
+                                                               {"object", type_object}};
+      if (name.is_string()) {
+        for (auto const &n : names) {
+          if (name == n.first)
+            return n.second;
+        }
+      }
+      throw std::invalid_argument("invalid schema: unknown type " + name.dump());
+    }
+
+    static double number(const json &schema, const char *keyword) {
+      const json &value = schema[keyword];
+      if (!value.is_number())
+        throw std::invalid_argument(std::string("invalid schema: ") + keyword + " must be a number");
+      return value.get<double>();
+    }
+
+    static size_t count(const json &schema, const char *keyword) {
+      const json &value = schema[keyword];
+      if (!value.is_number_unsigned() && !(value.is_number_integer() && value.get<long long>() >= 0))
+        throw std::invalid_argument(std::string("invalid schema: ") + keyword + " must be a non-negative integer");
+      return value.get<size_t>();
+    }
+
+    size_t compile(const json &schema) {
+      if (!schema.is_object())
+        throw std::invalid_argument("invalid schema: expected object, but is " + std::string(schema.type_name()));
+      size_t index = nodes.size();
+      nodes.emplace_back();
+      Node node;
+      if (has_key(schema, "type")) {
+        node.types = 0;
+        if (schema["type"].is_array()) {
+          for (auto const &t : schema["type"])
+            node.types |= parse_type(t);
+        } else {
+          node.types = parse_type(schema["type"]);
+        }
+      }
+      if (has_key(schema, "minimum")) {
+        node.minimum = number(schema, "minimum");
+        node.checks |= check_range;
+      }
+      if (has_key(schema, "maximum")) {
+        node.maximum = number(schema, "maximum");
+        node.checks |= check_range;
+      }
+      if (has_key(schema, "exclusiveMinimum")) {
+        node.minimum = number(schema, "exclusiveMinimum");
+        node.exclusive_minimum = true;
+        node.checks |= check_range;
+      }
+      if (has_key(schema, "exclusiveMaximum")) {
+        node.maximum = number(schema, "exclusiveMaximum");
+        node.exclusive_maximum = true;
+        node.checks |= check_range;
+      }
+      if (has_key(schema, "minLength")) {
+        node.min_length = count(schema, "minLength");
+        node.checks |= check_length;
+      }
+      if (has_key(schema, "maxLength")) {
+        node.max_length = count(schema, "maxLength");
+        node.checks |= check_length;
+      }
+      if (has_key(schema, "minItems")) {
+        node.min_items = count(schema, "minItems");
+        node.checks |= check_items;
+      }
+      if (has_key(schema, "maxItems")) {
+        node.max_items = count(schema, "maxItems");
+        node.checks |= check_items;
+      }
+      if (has_key(schema, "additionalProperties")) {
+        if (!schema["additionalProperties"].is_boolean())
+          throw std::invalid_argument("invalid schema: only boolean additionalProperties are supported");
+        node.additional_properties = schema["additionalProperties"].get<bool>();
+        node.checks |= check_properties;
+      }
+      if (has_key(schema, "required")) {
+        if (!schema["required"].is_array())
+          throw std::invalid_argument("invalid schema: required must be an array of strings");
+        node.required_begin = required.size();
+        for (auto const &r : schema["required"]) {
+          if (!r.is_string())
+            throw std::invalid_argument("invalid schema: required must be an array of strings");
+          required.push_back(r.get<std::string>());
+        }
+        node.required_end = required.size();
+        node.checks |= check_properties;
+      }
+      if (has_key(schema, "properties")) {
+        if (!schema["properties"].is_object())
+          throw std::invalid_argument("invalid schema: properties must be an object");
+        // The range is reserved before compiling the property schemas, which append their own properties
+        node.properties_begin = properties.size();
+        for (auto p = schema["properties"].begin(); p != schema["properties"].end(); ++p)
+          properties.emplace_back(p.key(), 0);
+        node.properties_end = properties.size();
+        size_t i = node.properties_begin;
+        for (auto const &p : schema["properties"])
+          properties[i++].second = compile(p);
+        node.checks |= check_properties;
+      }
+      if (has_key(schema, "items")) {
+        node.items = compile(schema["items"]);
+        node.checks |= check_items;
+      }
+      nodes[index] = node;
+      return index;
+    }
+
+    static uint8_t type_of(const json &value) {
+      switch (value.type()) {
+      case json::value_t::null:
+        return type_null;
+      case json::value_t::boolean:
+        return type_boolean;
+      case json::value_t::number_integer:
+      case json::value_t::number_unsigned:
+        return type_integer;
+      case json::value_t::number_float: {
+        double d = value.get<double>();
+        return std::isfinite(d) && std::floor(d) == d ? type_number | type_integer : type_number;
+      }
+      case json::value_t::string:
+        return type_string;
+      case json::value_t::array:
+        return type_array;
+      case json::value_t::object:
+        return type_object;
+      default:
+        return 0;
+      }
+    }
+
+    static std::string type_names(uint8_t types) {
+      static const std::pair<const char *, uint8_t> names[] = {{"null", type_null},     {"boolean", type_boolean}, {"number", type_number},
+                                                               {"integer", type_integer}, {"string", type_string}, {"array", type_array},
+                                                               {"object", type_object}};
+      std::string result;
+      for (auto const &n : names) {
+        if ((types & n.second) == 0 || (n.second == type_integer && (types & type_number) != 0))
+          continue;
+        if (!result.empty())
+          result += " or ";
+        result += n.first;
+      }
+      return result;
+    }
+
+    static size_t code_points(const std::string &value) {
+      size_t result = 0;
+      for (char c : value) {
+        if ((static_cast<unsigned char>(c) & 0xc0) != 0x80)
+          result++;
+      }
+      return result;
+    }
+
+    static std::string format(double value) {
+      if (std::floor(value) == value && std::fabs(value) < 9007199254740992.0)
+        return std::to_string(static_cast<long long>(value));
+      return json(value).dump();
+    }
+
+    // The path is built while unwinding, so valid values don't pay for it
+    bool validate(size_t index, const json &value, std::string &error, std::string &path) const {
+      const Node &node = nodes[index];
+      uint8_t type = type_of(value);
+      if ((node.types & type) == 0) {
+        error = "must be " + type_names(node.types) + ", but is " + value.type_name();
+        return false;
+      }
+      if (node.checks == 0)
+        return true;
+      if ((type & (type_integer | type_number)) != 0) {
+        if ((node.checks & check_range) != 0)
+          return validate_range(node, value.get<double>(), error);
+      } else if (type == type_string && (node.checks & check_length) != 0) {
+        size_t length = code_points(value.get_ref<const std::string &>());
+        if (length < node.min_length) {
+          error = "must be at least " + std::to_string(node.min_length) + " characters long";
+          return false;
+        }
+        if (length > node.max_length) {
+          error = "must be at most " + std::to_string(node.max_length) + " characters long";
+          return false;
+        }
+      } else if (type == type_array && (node.checks & check_items) != 0) {
+        if (value.size() < node.min_items) {
+          error = "must have at least " + std::to_string(node.min_items) + " items";
+          return false;
+        }
+        if (value.size() > node.max_items) {
+          error = "must have at most " + std::to_string(node.max_items) + " items";
+          return false;
+        }
+        if (node.items != 0) {
+          for (size_t i = 0; i < value.size(); i++) {
+            if (!validate(node.items, value[i], error, path)) {
+              path.insert(0, "/" + std::to_string(i));
+              return false;
+            }
+          }
+        }
+      } else if (type == type_object && (node.checks & check_properties) != 0) {
+        return validate_object(node, value, error, path);
+      }
+      return true;
+    }
+
+    static bool validate_range(const Node &node, double number, std::string &error) {
+      if (node.exclusive_minimum ? number <= node.minimum : number < node.minimum) {
+        error = std::string("must be ") + (node.exclusive_minimum ? "> " : ">= ") + format(node.minimum);
+        return false;
+      }
+      if (node.exclusive_maximum ? number >= node.maximum : number > node.maximum) {
+        error = std::string("must be ") + (node.exclusive_maximum ? "< " : "<= ") + format(node.maximum);
+        return false;
+      }
+      return true;
+    }
+
+    bool validate_object(const Node &node, const json &value, std::string &error, std::string &path) const {
+      for (size_t r = node.required_begin; r < node.required_end; r++) {
+        if (value.find(required[r]) == value.end()) {
+          error = "missing required property \"" + required[r] + "\"";
+          return false;
+        }
+      }
+      size_t known = 0;
+      for (size_t p = node.properties_begin; p < node.properties_end; p++) {
+        auto property = value.find(properties[p].first);
+        if (property == value.end())
+          continue;
+        known++;
+        if (!validate(properties[p].second, *property, error, path)) {
+          path.insert(0, "/" + properties[p].first);
+          return false;
+        }
+      }
+      if (!node.additional_properties && known != value.size()) {
+        for (auto p = value.begin(); p != value.end(); ++p) {
+          if (!declared(node, p.key())) {
+            error = "unexpected property \"" + p.key() + "\"";
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    bool declared(const Node &node, const std::string &name) const {
+      for (size_t p = node.properties_begin; p < node.properties_end; p++) {
+        if (properties[p].first == name)
+          return true;
+      }
+      return false;
+    }
+  };
+} // namespace jsonrpccxx
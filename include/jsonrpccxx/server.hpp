@@ -2,109 +2,482 @@
 
 #include "common.hpp"
 #include "dispatcher.hpp"
+#include "interceptor.hpp"
+#include "notificationqueue.hpp"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace jsonrpccxx {
   class JsonRpcServer {
   public:
-    JsonRpcServer() : dispatcher() {}
+    JsonRpcServer() : dispatcher(), interceptors(), notifications() {}
     virtual ~JsonRpcServer() = default;
     virtual std::string HandleRequest(const std::string &request) = 0;
 
-    bool Add(const std::string &name, MethodHandle callback, const NamedParamMapping &mapping = NAMED_PARAM_MAPPING) {
+    bool Add(const std::string &name, MethodHandle callback, const NamedParamMapping &mapping = NAMED_PARAM_MAPPING, const MethodOptions &options = {}) {
       if (name.rfind("rpc.", 0) == 0)
         return false;
-      return dispatcher.Add(name, callback, mapping);
+      return dispatcher.Add(name, callback, mapping, options);
     }
-    bool Add(const std::string &name, NotificationHandle callback, const NamedParamMapping &mapping = NAMED_PARAM_MAPPING) {
+    bool Add(const std::string &name, NotificationHandle callback, const NamedParamMapping &mapping = NAMED_PARAM_MAPPING, const MethodOptions &options = {}) {
       if (name.rfind("rpc.", 0) == 0)
         return false;
-      return dispatcher.Add(name, callback, mapping);
+      return dispatcher.Add(name, callback, mapping, options);
+    }
+
+    // Collects per method call counts, errors and latencies and serves them via the reserved "rpc.stats" method
+    void EnableStatistics() {
+      dispatcher.EnableStatistics();
+      dispatcher.Add("rpc.stats", GetUncheckedHandle([this](const json &) -> json { return dispatcher.GetStatistics(); }));
+    }
+    std::map<std::string, MethodStatisticsSnapshot> GetStatistics() const { return dispatcher.GetStatistics(); }
+    void ResetStatistics() { dispatcher.ResetStatistics(); }
+
+    std::map<std::string, CacheStatistics> GetCacheStatistics() const { return dispatcher.GetCacheStatistics(); }
+    bool InvalidateCache(const std::string &name) { return dispatcher.InvalidateCache(name); }
+    bool InvalidateCache(const std::string &name, const json &params) { return dispatcher.InvalidateCache(name, params); }
+    void InvalidateCaches() { dispatcher.InvalidateCaches(); }
+
+    // Serves an OpenRPC document describing the registered methods via the reserved "rpc.discover" method
+    void EnableDiscovery(const std::string &title = "JSON-RPC server", const std::string &version = "1.0.0") {
+      dispatcher.EnableDiscovery({{"title", title}, {"version", version}});
+      dispatcher.Add("rpc.discover", MethodHandle(DocumentHandle{&dispatcher.DiscoveryDocument()}));
+    }
+
+    // Methods are routed to executors via MethodOptions::executor, executors must be added before the methods using them.
+    // Methods on executors other than "inline" must be thread-safe, the calls of a batch are run concurrently then.
+    void AddExecutor(const std::string &name, std::shared_ptr<Executor> executor) { dispatcher.AddExecutor(name, std::move(executor)); }
+
+    // Calls still queued when their deadline passes are answered with deadline_exceeded instead of being run. Deadlines
+    // are counted from the arrival of the request, MethodOptions::deadline overrides this default and a "timeout" member
+    // of the request (milliseconds) can only shorten them. Must be set before serving requests.
+    void SetDefaultDeadline(std::optional<std::chrono::milliseconds> deadline) { dispatcher.SetDefaultDeadline(deadline); }
+
+    // Interceptors are called in the order they were added, must be added before serving requests
+    void AddInterceptor(Interceptor interceptor) { interceptors.Add(std::move(interceptor)); }
+
+    // Notifications are queued and run by a pool of workers, so requests are answered without waiting for them. Must be
+    // enabled before serving requests, queued notifications are still run when the server is destroyed.
+    void EnableAsyncNotifications(const NotificationQueueOptions &options = {}) { notifications = std::make_unique<NotificationQueue>(options); }
+    // Blocks until all queued notifications have run
+    void WaitForNotifications() {
+      if (notifications)
+        notifications->Drain();
+    }
+    NotificationQueueStatistics GetNotificationQueueStatistics() const {
+      return notifications ? notifications->Statistics() : NotificationQueueStatistics{0, 0, 0, 0, 0, 0, 0};
     }
 
   protected:
     Dispatcher dispatcher;
-  };
+    InterceptorChain interceptors;
+    // Declared last, so workers are stopped before the dispatcher is destroyed
+    std::unique_ptr<NotificationQueue> notifications;
 
-  class JsonRpc2Server : public JsonRpcServer {
-  public:
-    JsonRpc2Server() = default;
-    ~JsonRpc2Server() override = default;
+    // Servers dispatching to their own members must stop the workers in their destructor
+    void stop_notifications() { notifications.reset(); }
 
-    std::string HandleRequest(const std::string &requestString) override {
+    // Answers with a pre-serialized document, which the dispatcher keeps up to date
+    struct DocumentHandle {
+      const std::string *document;
+      json operator()(const json &) const { return json::parse(*document); }
+      void Write(const json &, std::string &out) const { out += *document; }
+    };
+
+    // Parses a request or batch document, handle_single(request, out) appends the response of a single request and
+    // returns false if there is none. Top-level failures are answered with error_response(code, message).
+    template <typename HandleSingle, typename ErrorResponse>
+    std::string handle_document(const std::string &requestString, HandleSingle &&handle_single, ErrorResponse &&error_response) {
+      // Deadlines count from here, so time spent queued behind other calls of a batch counts against them
+      RequestTimingScope timing(RequestTiming{DeadlineClock::now(), DeadlineClock::time_point::max()});
       try {
         json request = json::parse(requestString);
         if (request.is_array()) {
-          json result = json::array();
+          if (request.size() > 1 && has_pooled_call(request)) {
+            return handle_batch_concurrently(request, handle_single);
+          }
+          std::string result = "[";
           for (json &r : request) {
-            json res = this->HandleSingleRequest(r);
-            if (!res.is_null()) {
-              result.push_back(std::move(res));
+            size_t start = result.size();
+            if (start > 1) {
+              result += ',';
+            }
+            if (!handle_single(r, result)) {
+              result.resize(start);
             }
           }
-          return result.dump();
+          result += ']';
+          return result;
         } else if (request.is_object()) {
-          json res = HandleSingleRequest(request);
-          if (!res.is_null()) {
-            return res.dump();
-          } else {
-            return "";
-          }
+          std::string result;
+          handle_single(request, result);
+          return result;
         } else {
-          return json{{"id", nullptr}, {"error", {{"code", invalid_request}, {"message", "invalid request: expected array or object"}}}, {"jsonrpc", "2.0"}}.dump();
+          return error_response(invalid_request, "invalid request: expected array or object");
         }
       } catch (json::parse_error &e) {
-        return json{{"id", nullptr}, {"error", {{"code", parse_error}, {"message", std::string("parse error: ") + e.what()}}}, {"jsonrpc", "2.0"}}.dump();
+        return error_response(parse_error, std::string("parse error: ") + e.what());
       }
     }
 
-  private:
-    json HandleSingleRequest(json &request) {
-      json id = nullptr;
-      if (valid_id(request)) {
-        id = request["id"];
+    Executor *executor_of(const json &request) const {
+      if (!request.is_object())
+        return nullptr;
+      auto method = request.find("method");
+      if (method == request.end() || !method->is_string())
+        return nullptr;
+      Executor *executor = dispatcher.FindExecutor(method->get_ref<const std::string &>());
+      return executor != nullptr && !executor->RunsDirectly() ? executor : nullptr;
+    }
+
+    bool has_pooled_call(const json &batch) const {
+      for (auto const &r : batch) {
+        if (executor_of(r) != nullptr)
+          return true;
+      }
+      return false;
+    }
+
+    // Calls routed to an executor are started first, so they run while the remaining calls are handled on this thread.
+    // Responses keep the order of the batch.
+    template <typename HandleSingle>
+    std::string handle_batch_concurrently(json &batch, HandleSingle &handle_single) {
+      std::vector<Executor *> executors(batch.size());
+      for (size_t i = 0; i < batch.size(); i++)
+        executors[i] = executor_of(batch[i]);
+      std::vector<std::string> responses(batch.size());
+      // Not std::vector<bool>, elements are written concurrently
+      std::vector<char> answered(batch.size(), false);
+      std::mutex mutex;
+      std::condition_variable finished;
+      size_t running = 0;
+      const RequestTiming timing = RequestTiming::Current();
+      auto handle = [&](size_t i) {
+        RequestTimingScope scope(timing);
+        try {
+          answered[i] = handle_single(batch[i], responses[i]);
+        } catch (...) {
+        }
+      };
+      for (size_t i = 0; i < batch.size(); i++) {
+        if (executors[i] == nullptr)
+          continue;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          running++;
+        }
+        auto done = [&]() {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (--running == 0)
+            finished.notify_one();
+        };
+        try {
+          executors[i]->Execute([&handle, done, i]() {
+            handle(i);
+            done();
+          });
+        } catch (...) {
+          done();
+          executors[i] = nullptr;
+        }
+      }
+      for (size_t i = 0; i < batch.size(); i++) {
+        if (executors[i] == nullptr)
+          handle(i);
+      }
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&running]() { return running == 0; });
+      }
+      std::string result = "[";
+      for (size_t i = 0; i < batch.size(); i++) {
+        if (!answered[i])
+          continue;
+        if (result.size() > 1)
+          result += ',';
+        result += responses[i];
       }
+      result += ']';
+      return result;
+    }
+
+    // Error object of the exception currently handled
+    static json current_error() {
       try {
-        return ProcessSingleRequest(request);
+        throw;
       } catch (JsonRpcException &e) {
         json error = {{"code", e.Code()}, {"message", e.Message()}};
         if (!e.Data().is_null()) {
           error["data"] = e.Data();
         }
-        return json{{"id", id}, {"error", error}, {"jsonrpc", "2.0"}};
+        return error;
       } catch (std::exception &e) {
-        return json{{"id", id}, {"error", {{"code", internal_error}, {"message", std::string("internal server error: ") + e.what()}}}, {"jsonrpc", "2.0"}};
+        return {{"code", internal_error}, {"message", std::string("internal server error: ") + e.what()}};
       } catch (...) {
-        return json{{"id", id}, {"error", {{"code", internal_error}, {"message", std::string("internal server error")}}}, {"jsonrpc", "2.0"}};
+        return {{"code", internal_error}, {"message", std::string("internal server error")}};
       }
     }
 
-    json ProcessSingleRequest(json &request) {
-      if (!has_key_type(request, "jsonrpc", json::value_t::string) || request["jsonrpc"] != "2.0") {
+    // Envelope members of a request, found in a single pass over the request object. Members are null if missing.
+    struct Envelope {
+      explicit Envelope(json &request) : jsonrpc(nullptr), method(nullptr), id(nullptr), params(nullptr), timeout(nullptr) {
+        if (!request.is_object())
+          return;
+        for (auto it = request.begin(); it != request.end(); ++it) {
+          const std::string &key = it.key();
+          if (key == "id") {
+            id = &it.value();
+          } else if (key == "method") {
+            method = &it.value();
+          } else if (key == "params") {
+            params = &it.value();
+          } else if (key == "jsonrpc") {
+            jsonrpc = &it.value();
+          } else if (key == "timeout") {
+            timeout = &it.value();
+          }
+        }
+      }
+
+      json *jsonrpc;
+      json *method;
+      json *id;
+      json *params;
+      // Milliseconds the client waits for the response, not part of the specification
+      json *timeout;
+
+      bool ValidId() const { return id->is_number() || id->is_string() || id->is_null(); }
+      bool ValidParams() const { return params == nullptr || params->is_array() || params->is_object() || params->is_null(); }
+      bool ValidTimeout() const { return timeout == nullptr || (timeout->is_number() && timeout->get<double>() >= 0); }
+      // Timing of the request with the deadline of the client, timeout must be set
+      RequestTiming Timing() const {
+        RequestTiming timing = RequestTiming::Current();
+        if (!timing.Known()) {
+          timing.arrival = DeadlineClock::now();
+        }
+        // Longer timeouts would overflow the clock and are treated as none
+        double milliseconds = timeout->get<double>();
+        if (milliseconds < 1e12) {
+          auto duration = std::chrono::duration_cast<DeadlineClock::duration>(std::chrono::duration<double, std::milli>(milliseconds));
+          timing.deadline = std::min(timing.deadline, timing.arrival + duration);
+        }
+        return timing;
+      }
+      // Missing and null params are passed as empty array, which is stored in fallback
+      json &Params(json &fallback) const {
+        if (params != nullptr && !params->is_null())
+          return *params;
+        fallback = json::array();
+        return fallback;
+      }
+    };
+
+    static const json &null_id() {
+      static const json id;
+      return id;
+    }
+
+    // Appends the serialized result to out
+    void invoke_method(const std::string &method, const json &id, json &params, std::string &out) {
+      intercept_method(method, id, params, out, [this](const std::string &m, auto &&p, std::string &o) { dispatcher.InvokeMethod(m, std::forward<decltype(p)>(p), o); });
+    }
+
+    void invoke_notification(const std::string &method, json &params) {
+      intercept_notification(method, params, [this](const std::string &m, auto &&p) { dispatcher.InvokeNotification(m, std::forward<decltype(p)>(p)); });
+    }
+
+    // Without interceptors params are handed to dispatch as rvalue, arguments are moved out of the request.
+    // Interceptors may still inspect params after the call, so they are passed as lvalue then.
+    template <typename Dispatch>
+    void intercept_method(const std::string &method, const json &id, json &params, std::string &out, Dispatch &&dispatch) {
+      if (interceptors.Empty()) {
+        dispatch(method, std::move(params), out);
+        return;
+      }
+      size_t start = out.size();
+      RequestContext context{method, id, params, false};
+      auto terminal = [&dispatch, &context, &out]() { dispatch(context.method, context.params, out); };
+      interceptors.Run(context, terminal);
+      if (out.size() == start) {
+        out += "null";
+      }
+    }
+
+    template <typename Dispatch>
+    void intercept_notification(const std::string &method, json &params, Dispatch &&dispatch) {
+      if (notifications) {
+        notifications->Submit([this, method, params = std::move(params), dispatch, timing = RequestTiming::Current()]() mutable {
+          RequestTimingScope scope(timing);
+          run_notification(method, params, dispatch);
+        });
+        return;
+      }
+      run_notification(method, params, dispatch);
+    }
+
+    template <typename Dispatch>
+    void run_notification(const std::string &method, json &params, Dispatch &dispatch) {
+      if (interceptors.Empty()) {
+        dispatch(method, std::move(params));
+        return;
+      }
+      RequestContext context{method, null_id(), params, true};
+      auto terminal = [&dispatch, &context]() { dispatch(context.method, context.params); };
+      interceptors.Run(context, terminal);
+    }
+  };
+
+  class JsonRpc2Server : public JsonRpcServer {
+  public:
+    JsonRpc2Server() = default;
+    ~JsonRpc2Server() override = default;
+
+    std::string HandleRequest(const std::string &requestString) override { return handle_request(requestString, *this); }
+
+  protected:
+    // Invoker provides invoke_method() and invoke_notification(), so derived servers can replace dispatching
+    template <typename Invoker>
+    std::string handle_request(const std::string &requestString, Invoker &invoker) {
+      return handle_document(
+          requestString, [this, &invoker](json &request, std::string &out) { return HandleSingleRequest(request, out, invoker); },
+          [](int code, const std::string &message) { return json{{"id", nullptr}, {"error", {{"code", code}, {"message", message}}}, {"jsonrpc", "2.0"}}.dump(); });
+    }
+
+  private:
+    // Appends the response to out, returns false if there is none
+    template <typename Invoker>
+    bool HandleSingleRequest(json &request, std::string &out, Invoker &invoker) {
+      Envelope envelope(request);
+      size_t start = out.size();
+      try {
+        return ProcessSingleRequest(envelope, out, invoker);
+      } catch (...) {
+        out.resize(start);
+        // Same layout as json::dump() of {"error", "id", "jsonrpc"}, the id is written from the request without a copy
+        out += "{\"error\":";
+        write_json(out, current_error());
+        out += ",\"id\":";
+        write_json(out, envelope.id != nullptr && envelope.ValidId() ? *envelope.id : null_id());
+        out += ",\"jsonrpc\":\"2.0\"}";
+      }
+      return true;
+    }
+
+    template <typename Invoker>
+    bool ProcessSingleRequest(Envelope &request, std::string &out, Invoker &invoker) {
+      if (request.jsonrpc == nullptr || !request.jsonrpc->is_string() || request.jsonrpc->get_ref<const std::string &>() != "2.0") {
         throw JsonRpcException(invalid_request, R"(invalid request: missing jsonrpc field set to "2.0")");
       }
-      if (!has_key_type(request, "method", json::value_t::string)) {
+      if (request.method == nullptr || !request.method->is_string()) {
         throw JsonRpcException(invalid_request, "invalid request: method field must be a string");
       }
-      if (has_key(request, "id") && !valid_id(request)) {
+      if (request.id != nullptr && !request.ValidId()) {
         throw JsonRpcException(invalid_request, "invalid request: id field must be a number, string or null");
       }
-      if (has_key(request, "params") && !(request["params"].is_array() || request["params"].is_object() || request["params"].is_null())) {
+      if (!request.ValidParams()) {
         throw JsonRpcException(invalid_request, "invalid request: params field must be an array, object or null");
       }
-      if (!has_key(request, "params") || has_key_type(request, "params", json::value_t::null)) {
-        request["params"] = json::array();
+      if (!request.ValidTimeout()) {
+        throw JsonRpcException(invalid_request, "invalid request: timeout field must be a non-negative number");
       }
-      if (!has_key(request, "id")) {
+      std::optional<RequestTimingScope> timing;
+      if (request.timeout != nullptr) {
+        timing.emplace(request.Timing());
+      }
+      json noParams;
+      json &params = request.Params(noParams);
+      const std::string &method = request.method->get_ref<const std::string &>();
+      if (request.id == nullptr) {
         try {
-          dispatcher.InvokeNotification(request["method"], request["params"]);
-          return json();
+          invoker.invoke_notification(method, params);
         } catch (std::exception &) {
-          return json();
         }
-      } else {
-        return {{"jsonrpc", "2.0"}, {"id", request["id"]}, {"result", dispatcher.InvokeMethod(request["method"], request["params"])}};
+        return false;
+      }
+      // Same layout as json::dump() of {"id", "jsonrpc", "result"}, keys in sorted order
+      out += "{\"id\":";
+      write_json(out, *request.id);
+      out += ",\"jsonrpc\":\"2.0\",\"result\":";
+      invoker.invoke_method(method, *request.id, params, out);
+      out += '}';
+      return true;
+    }
+  };
+
+  // JSON-RPC 1.0: requests carry no "jsonrpc" field, notifications are requests with "id": null and responses always
+  // contain both "result" and "error". Batches are answered like in 2.0, leaving out notifications.
+  class JsonRpc1Server : public JsonRpcServer {
+  public:
+    JsonRpc1Server() = default;
+    ~JsonRpc1Server() override = default;
+
+    std::string HandleRequest(const std::string &requestString) override { return handle_request(requestString, *this); }
+
+  protected:
+    template <typename Invoker>
+    std::string handle_request(const std::string &requestString, Invoker &invoker) {
+      return handle_document(
+          requestString, [this, &invoker](json &request, std::string &out) { return HandleSingleRequest(request, out, invoker); },
+          [](int code, const std::string &message) { return json{{"error", {{"code", code}, {"message", message}}}, {"id", nullptr}, {"result", nullptr}}.dump(); });
+    }
+
+  private:
+    template <typename Invoker>
+    bool HandleSingleRequest(json &request, std::string &out, Invoker &invoker) {
+      Envelope envelope(request);
+      size_t start = out.size();
+      try {
+        return ProcessSingleRequest(envelope, out, invoker);
+      } catch (...) {
+        out.resize(start);
+        out += "{\"error\":";
+        write_json(out, current_error());
+        out += ",\"id\":";
+        write_json(out, envelope.id != nullptr ? *envelope.id : null_id());
+        out += ",\"result\":null}";
+      }
+      return true;
+    }
+
+    template <typename Invoker>
+    bool ProcessSingleRequest(Envelope &request, std::string &out, Invoker &invoker) {
+      if (request.method == nullptr || !request.method->is_string()) {
+        throw JsonRpcException(invalid_request, "invalid request: method field must be a string");
+      }
+      if (request.id == nullptr) {
+        throw JsonRpcException(invalid_request, "invalid request: missing id field, notifications must set it to null");
+      }
+      if (!request.ValidParams()) {
+        throw JsonRpcException(invalid_request, "invalid request: params field must be an array, object or null");
+      }
+      if (!request.ValidTimeout()) {
+        throw JsonRpcException(invalid_request, "invalid request: timeout field must be a non-negative number");
+      }
+      std::optional<RequestTimingScope> timing;
+      if (request.timeout != nullptr) {
+        timing.emplace(request.Timing());
+      }
+      json noParams;
+      json &params = request.Params(noParams);
+      const std::string &method = request.method->get_ref<const std::string &>();
+      if (request.id->is_null()) {
+        try {
+          invoker.invoke_notification(method, params);
+        } catch (std::exception &) {
+        }
+        return false;
       }
+      // Same layout as json::dump() of {"error", "id", "result"}, keys in sorted order
+      out += "{\"error\":null,\"id\":";
+      write_json(out, *request.id);
+      out += ",\"result\":";
+      invoker.invoke_method(method, *request.id, params, out);
+      out += '}';
+      return true;
     }
   };
 }
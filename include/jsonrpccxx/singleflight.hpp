@@ -0,0 +1,83 @@
+#pragma once
+
+#include "common.hpp"
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace jsonrpccxx {
+  // Deduplicates concurrent calls of a single method with identical normalized params: the first caller executes the
+  // method, all callers arriving while it runs wait for it and receive the same serialized result or exception.
+  class SingleFlight {
+  public:
+    SingleFlight() : mutex(), calls(), waiters(0) {}
+
+    // execute appends the serialized result to its argument, the shared result is appended to out
+    template <typename Execute>
+    void Do(const json &params, std::string &out, Execute &&execute) {
+      size_t hash = std::hash<json>{}(params);
+      std::unique_lock<std::mutex> lock(mutex);
+      std::shared_ptr<Call> call = find(hash, params);
+      if (call != nullptr) {
+        waiters++;
+        call->done.wait(lock, [&call]() { return call->finished; });
+        waiters--;
+        lock.unlock();
+        if (call->error)
+          std::rethrow_exception(call->error);
+        out += call->result;
+        return;
+      }
+      call = std::make_shared<Call>(params);
+      auto entry = calls.emplace(hash, call);
+      lock.unlock();
+
+      try {
+        execute(call->result);
+      } catch (...) {
+        call->error = std::current_exception();
+      }
+
+      lock.lock();
+      calls.erase(entry);
+      call->finished = true;
+      call->done.notify_all();
+      lock.unlock();
+      if (call->error)
+        std::rethrow_exception(call->error);
+      out += call->result;
+    }
+
+    // Number of callers currently waiting for a shared execution
+    size_t Waiters() const {
+      std::lock_guard<std::mutex> lock(mutex);
+      return waiters;
+    }
+
+  private:
+    struct Call {
+      explicit Call(const json &params) : params(params), done(), finished(false), result(), error() {}
+      json params;
+      std::condition_variable done;
+      bool finished;
+      std::string result;
+      std::exception_ptr error;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_multimap<size_t, std::shared_ptr<Call>> calls;
+    size_t waiters;
+
+    std::shared_ptr<Call> find(size_t hash, const json &params) {
+      auto range = calls.equal_range(hash);
+      for (auto i = range.first; i != range.second; ++i) {
+        if (i->second->params == params)
+          return i->second;
+      }
+      return nullptr;
+    }
+  };
+} // namespace jsonrpccxx
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "common.hpp"
+#include "typemapper.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace jsonrpccxx {
+  // FNV-1a, usable at compile time for method names and at runtime for requested names
+  constexpr uint64_t method_hash(const char *name, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211ull;
+    }
+    return hash;
+  }
+  constexpr size_t method_name_length(const char *name) {
+    size_t size = 0;
+    while (name[size] != '\0') {
+      size++;
+    }
+    return size;
+  }
+
+  template <typename F>
+  struct function_traits;
+  template <typename R, typename... A>
+  struct function_traits<R (*)(A...)> {
+    typedef R return_type;
+    typedef std::tuple<A...> arguments;
+  };
+  template <typename T, typename R, typename... A>
+  struct function_traits<R (T::*)(A...)> : function_traits<R (*)(A...)> {};
+  template <typename T, typename R, typename... A>
+  struct function_traits<R (T::*)(A...) const> : function_traits<R (*)(A...)> {};
+
+  // A method known at compile time: Name and ParamNames must have static storage duration, e.g. static constexpr char arrays.
+  // Function is a free function or a member function of the instance the dispatcher is bound to.
+  template <const char *Name, auto Function, const char *... ParamNames>
+  struct Method {
+    static constexpr const char *name = Name;
+    static constexpr size_t length = method_name_length(Name);
+    static constexpr uint64_t hash = method_hash(Name, length);
+    static constexpr auto function = Function;
+    typedef typename function_traits<decltype(Function)>::return_type return_type;
+    typedef typename function_traits<decltype(Function)>::arguments arguments;
+    static constexpr std::array<const char *, sizeof...(ParamNames)> param_names = {ParamNames...};
+    static constexpr bool notification = std::is_void<return_type>::value;
+  };
+
+  template <typename... M>
+  struct Methods {
+    static constexpr bool unique_hashes() {
+      std::array<uint64_t, sizeof...(M)> hashes = {M::hash...};
+      for (size_t i = 0; i < hashes.size(); i++) {
+        for (size_t j = i + 1; j < hashes.size(); j++) {
+          if (hashes[i] == hashes[j])
+            return false;
+        }
+      }
+      return true;
+    }
+    static_assert(unique_hashes(), "method names must be unique and must not collide in their hash");
+  };
+
+  // Dispatches to a fixed set of methods without any runtime registration: the requested name is hashed once and compared
+  // against the compile-time hashes of all methods, arguments are converted straight into the call of the bound function.
+  // Functions returning void are notifications, all others are methods.
+  template <typename Instance, typename Registry>
+  class StaticDispatcher;
+
+  template <typename Instance, typename... M>
+  class StaticDispatcher<Instance, Methods<M...>> {
+  public:
+    explicit StaticDispatcher(Instance &instance) : instance(instance) {}
+
+    bool ContainsMethod(const std::string &name) const { return ((!M::notification && matches<M>(method_hash(name.data(), name.size()), name)) || ...); }
+    bool ContainsNotification(const std::string &name) const { return ((M::notification && matches<M>(method_hash(name.data(), name.size()), name)) || ...); }
+
+    json InvokeMethod(const std::string &name, const json &params) {
+      json result;
+      uint64_t hash = method_hash(name.data(), name.size());
+      if (!(try_method<M>(hash, name, params, result) || ...)) {
+        throw JsonRpcException(method_not_found, "method not found: " + name);
+      }
+      return result;
+    }
+
+    void InvokeNotification(const std::string &name, const json &params) {
+      if (!TryInvokeNotification(name, params)) {
+        throw JsonRpcException(method_not_found, "notification not found: " + name);
+      }
+    }
+
+    // Appends the serialized result to out, returns false if there is no such method
+    bool TryInvokeMethod(const std::string &name, const json &params, std::string &out) {
+      uint64_t hash = method_hash(name.data(), name.size());
+      return (try_method<M>(hash, name, params, out) || ...);
+    }
+
+    // Returns false if there is no such notification
+    bool TryInvokeNotification(const std::string &name, const json &params) {
+      uint64_t hash = method_hash(name.data(), name.size());
+      return (try_notification<M>(hash, name, params) || ...);
+    }
+
+  private:
+    Instance &instance;
+
+    template <typename Entry>
+    static bool matches(uint64_t hash, const std::string &name) {
+      return hash == Entry::hash && name.size() == Entry::length && name.compare(0, Entry::length, Entry::name) == 0;
+    }
+
+    template <typename Entry>
+    bool try_method(uint64_t hash, const std::string &name, const json &params, std::string &out) {
+      if constexpr (Entry::notification) {
+        return false;
+      } else {
+        if (!matches<Entry>(hash, name))
+          return false;
+        out += json(invoke<Entry>(params)).dump();
+        return true;
+      }
+    }
+
+    template <typename Entry>
+    bool try_method(uint64_t hash, const std::string &name, const json &params, json &result) {
+      if constexpr (Entry::notification) {
+        return false;
+      } else {
+        if (!matches<Entry>(hash, name))
+          return false;
+        result = invoke<Entry>(params);
+        return true;
+      }
+    }
+
+    template <typename Entry>
+    bool try_notification(uint64_t hash, const std::string &name, const json &params) {
+      if constexpr (!Entry::notification) {
+        return false;
+      } else {
+        if (!matches<Entry>(hash, name))
+          return false;
+        invoke<Entry>(params);
+        return true;
+      }
+    }
+
+    template <typename Entry>
+    auto invoke(const json &params) -> typename Entry::return_type {
+      typedef typename Entry::arguments arguments;
+      try {
+        if (params.is_array()) {
+          return call<Entry>(params, static_cast<arguments *>(nullptr), std::make_index_sequence<std::tuple_size<arguments>::value>());
+        } else if (params.is_object()) {
+          return call<Entry>(positional<Entry>(params), static_cast<arguments *>(nullptr), std::make_index_sequence<std::tuple_size<arguments>::value>());
+        }
+        throw JsonRpcException(invalid_request, "invalid request: params field must be an array, object");
+      } catch (json::type_error &e) {
+        throw JsonRpcException(invalid_params, "invalid parameter: " + std::string(e.what()));
+      } catch (JsonRpcException &e) {
+        throw process_type_error<Entry>(e);
+      }
+    }
+
+    template <typename Entry, typename... A, size_t... index>
+    auto call(const json &params, std::tuple<A...> *, std::index_sequence<index...>) -> typename Entry::return_type {
+      size_t actualSize = params.size();
+      size_t formalSize = sizeof...(A);
+      if (actualSize != formalSize) {
+        throw JsonRpcException(invalid_params, "invalid parameter: expected " + std::to_string(formalSize) + " argument(s), but found " + std::to_string(actualSize));
+      }
+      (check_param_type<typename std::decay<A>::type>(index, params[index], GetType(type<typename std::decay<A>::type>())), ...);
+      if constexpr (std::is_member_function_pointer<decltype(Entry::function)>::value) {
+        return (instance.*Entry::function)(params[index].template get<typename std::decay<A>::type>()...);
+      } else {
+        return Entry::function(params[index].template get<typename std::decay<A>::type>()...);
+      }
+    }
+
+    template <typename Entry>
+    static json positional(const json &params) {
+      if (Entry::param_names.empty()) {
+        throw JsonRpcException(invalid_params, "invalid parameter: procedure doesn't support named parameter");
+      }
+      json result = json::array();
+      for (const char *p : Entry::param_names) {
+        auto value = params.find(p);
+        if (value == params.end()) {
+          throw JsonRpcException(invalid_params, "invalid parameter: missing named parameter \"" + std::string(p) + "\"");
+        }
+        result.push_back(*value);
+      }
+      return result;
+    }
+
+    template <typename Entry>
+    static JsonRpcException process_type_error(JsonRpcException &e) {
+      if (e.Code() == -32602 && !e.Data().empty()) {
+        size_t index = e.Data().get<unsigned int>();
+        std::string message = e.Message() + " for parameter ";
+        if (index < Entry::param_names.size()) {
+          message += "\"" + std::string(Entry::param_names[index]) + "\"";
+        } else {
+          message += std::to_string(index);
+        }
+        return JsonRpcException(e.Code(), message);
+      }
+      return e;
+    }
+  };
+} // namespace jsonrpccxx
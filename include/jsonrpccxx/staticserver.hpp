@@ -0,0 +1,39 @@
+#pragma once
+
+#include "server.hpp"
+#include "staticdispatcher.hpp"
+#include <string>
+
+namespace jsonrpccxx {
+  // JSON-RPC 2.0 server with a compile-time method registry, e.g.
+  //   StaticJsonRpc2Server<Warehouse, Methods<Method<getProduct, &Warehouse::GetProduct, id>>> server(warehouse);
+  // Methods added at runtime via Add() are still served, but only if no static method has the same name.
+  template <typename Instance, typename Registry>
+  class StaticJsonRpc2Server : public JsonRpc2Server {
+  public:
+    explicit StaticJsonRpc2Server(Instance &instance) : JsonRpc2Server(), methods(instance) {}
+    ~StaticJsonRpc2Server() override { stop_notifications(); }
+
+    std::string HandleRequest(const std::string &requestString) override { return handle_request(requestString, *this); }
+
+  private:
+    friend class JsonRpc2Server;
+    StaticDispatcher<Instance, Registry> methods;
+
+    void invoke_method(const std::string &method, const json &id, json &params, std::string &out) {
+      intercept_method(method, id, params, out, [this](const std::string &m, auto &&p, std::string &o) {
+        if (!methods.TryInvokeMethod(m, p, o)) {
+          dispatcher.InvokeMethod(m, std::forward<decltype(p)>(p), o);
+        }
+      });
+    }
+
+    void invoke_notification(const std::string &method, json &params) {
+      intercept_notification(method, params, [this](const std::string &m, auto &&p) {
+        if (!methods.TryInvokeNotification(m, p)) {
+          dispatcher.InvokeNotification(m, std::forward<decltype(p)>(p));
+        }
+      });
+    }
+  };
+} // namespace jsonrpccxx
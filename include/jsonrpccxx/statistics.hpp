@@ -0,0 +1,218 @@
+#pragma once
+
+#include "common.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace jsonrpccxx {
+  // Log-linear (HDR style) bucketing of nanosecond latencies: values below 2^sub_bucket_bits are counted exactly,
+  // every following power of two is split into 2^sub_bucket_bits linear buckets (~12.5% relative precision).
+  namespace histogram {
+    constexpr unsigned sub_bucket_bits = 3;
+    constexpr uint64_t sub_bucket_count = uint64_t(1) << sub_bucket_bits;
+    constexpr unsigned max_exponent = 36; // ~68 seconds, larger values end up in the last bucket
+    constexpr size_t bucket_count = sub_bucket_count * (max_exponent - sub_bucket_bits + 2);
+
+    inline unsigned highest_bit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+      return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+      unsigned bit = 0;
+      while (value >>= 1)
+        bit++;
+      return bit;
+#endif
+    }
+
+    inline size_t bucket_index(uint64_t value) {
+      if (value < sub_bucket_count)
+        return static_cast<size_t>(value);
+      unsigned exponent = highest_bit(value);
+      if (exponent > max_exponent)
+        return bucket_count - 1;
+      unsigned shift = exponent - sub_bucket_bits;
+      return static_cast<size_t>((shift + 1) * sub_bucket_count + ((value >> shift) - sub_bucket_count));
+    }
+
+    // Highest value that is counted in the given bucket
+    inline uint64_t bucket_upper_bound(size_t index) {
+      if (index < sub_bucket_count)
+        return index;
+      uint64_t shift = index / sub_bucket_count - 1;
+      return ((sub_bucket_count + index % sub_bucket_count + 1) << shift) - 1;
+    }
+  } // namespace histogram
+
+  constexpr size_t error_type_count = 7;
+
+  // Groups error codes like JsonRpcException::Type(), with distinct slots for server_error and invalid codes
+  inline size_t error_type_index(int code) {
+    switch (code) {
+    case parse_error:
+      return 0;
+    case invalid_request:
+      return 1;
+    case method_not_found:
+      return 2;
+    case invalid_params:
+      return 3;
+    case internal_error:
+      return 4;
+    default:
+      return (code >= -32099 && code <= -32000) ? 5 : 6;
+    }
+  }
+
+  inline const char *error_type_name(size_t index) {
+    static const char *names[error_type_count] = {"parse_error", "invalid_request", "method_not_found", "invalid_params", "internal_error", "server_error", "invalid"};
+    return names[index];
+  }
+
+  struct MethodStatisticsSnapshot {
+    MethodStatisticsSnapshot() : calls(), errors(), total_ns(), max_ns(), buckets() {}
+
+    uint64_t calls;
+    std::array<uint64_t, error_type_count> errors;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    std::array<uint64_t, histogram::bucket_count> buckets;
+
+    uint64_t Errors(int code) const { return errors[error_type_index(code)]; }
+    uint64_t Errors() const {
+      uint64_t sum = 0;
+      for (auto e : errors)
+        sum += e;
+      return sum;
+    }
+    uint64_t Mean() const { return calls == 0 ? 0 : total_ns / calls; }
+
+    // Latency in nanoseconds below which the given fraction (0.0 - 1.0) of calls completed
+    uint64_t Percentile(double fraction) const {
+      if (calls == 0)
+        return 0;
+      auto target = static_cast<uint64_t>(fraction * static_cast<double>(calls) + 0.5);
+      if (target == 0)
+        target = 1;
+      uint64_t seen = 0;
+      for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= target)
+          return std::min(histogram::bucket_upper_bound(i), max_ns);
+      }
+      return max_ns;
+    }
+  };
+
+  inline void to_json(json &j, const MethodStatisticsSnapshot &s) {
+    json errors = json::object();
+    for (size_t i = 0; i < error_type_count; i++) {
+      if (s.errors[i] != 0)
+        errors[error_type_name(i)] = s.errors[i];
+    }
+    j = json{{"calls", s.calls},
+             {"errors", errors},
+             {"latency_ns", {{"mean", s.Mean()}, {"p50", s.Percentile(0.5)}, {"p90", s.Percentile(0.9)}, {"p99", s.Percentile(0.99)}, {"p999", s.Percentile(0.999)}, {"max", s.max_ns}}}};
+  }
+
+  // Call counters and latency histogram of a single method. Every thread writes into its own cache line aligned shard,
+  // so recording only needs relaxed atomic increments without contention between threads.
+  class MethodStatistics {
+  public:
+    static constexpr size_t shard_count = 8;
+
+    MethodStatistics() : shards(new Shard[shard_count]) {}
+
+    void Record(uint64_t nanoseconds) { record(nanoseconds, nullptr); }
+    void Record(uint64_t nanoseconds, int errorCode) { record(nanoseconds, &errorCode); }
+
+    MethodStatisticsSnapshot Snapshot() const {
+      MethodStatisticsSnapshot result;
+      for (size_t s = 0; s < shard_count; s++) {
+        const Shard &shard = shards[s];
+        result.calls += shard.calls.load(std::memory_order_relaxed);
+        result.total_ns += shard.total_ns.load(std::memory_order_relaxed);
+        result.max_ns = std::max(result.max_ns, shard.max_ns.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < error_type_count; i++)
+          result.errors[i] += shard.errors[i].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < histogram::bucket_count; i++)
+          result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+      }
+      return result;
+    }
+
+    // Not atomic with respect to concurrent calls, which may be counted partially
+    void Reset() {
+      for (size_t s = 0; s < shard_count; s++) {
+        Shard &shard = shards[s];
+        shard.calls.store(0, std::memory_order_relaxed);
+        shard.total_ns.store(0, std::memory_order_relaxed);
+        shard.max_ns.store(0, std::memory_order_relaxed);
+        for (auto &e : shard.errors)
+          e.store(0, std::memory_order_relaxed);
+        for (auto &b : shard.buckets)
+          b.store(0, std::memory_order_relaxed);
+      }
+    }
+
+  private:
+    struct alignas(64) Shard {
+      std::atomic<uint64_t> calls{0};
+      std::atomic<uint64_t> total_ns{0};
+      std::atomic<uint64_t> max_ns{0};
+      std::array<std::atomic<uint64_t>, error_type_count> errors{};
+      std::array<std::atomic<uint64_t>, histogram::bucket_count> buckets{};
+    };
+    std::unique_ptr<Shard[]> shards;
+
+    static size_t thread_shard() {
+      static std::atomic<size_t> next_shard{0};
+      thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % shard_count;
+      return shard;
+    }
+
+    void record(uint64_t nanoseconds, const int *errorCode) {
+      Shard &shard = shards[thread_shard()];
+      shard.calls.fetch_add(1, std::memory_order_relaxed);
+      shard.total_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+      shard.buckets[histogram::bucket_index(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+      if (errorCode != nullptr)
+        shard.errors[error_type_index(*errorCode)].fetch_add(1, std::memory_order_relaxed);
+      uint64_t max = shard.max_ns.load(std::memory_order_relaxed);
+      while (nanoseconds > max && !shard.max_ns.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+      }
+    }
+  };
+
+  // Measures a single invocation, records it as successful unless Fail() was called. Does nothing without statistics.
+  class StatisticsScope {
+  public:
+    explicit StatisticsScope(MethodStatistics *statistics)
+        : statistics(statistics), start(statistics ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()), errorCode(), failed(false) {}
+    StatisticsScope(const StatisticsScope &) = delete;
+    StatisticsScope &operator=(const StatisticsScope &) = delete;
+    ~StatisticsScope() {
+      if (statistics == nullptr)
+        return;
+      auto elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+      if (failed)
+        statistics->Record(elapsed, errorCode);
+      else
+        statistics->Record(elapsed);
+    }
+
+    void Fail(int code) {
+      errorCode = code;
+      failed = true;
+    }
+
+  private:
+    MethodStatistics *statistics;
+    std::chrono::steady_clock::time_point start;
+    int errorCode;
+    bool failed;
+  };
+} // namespace jsonrpccxx
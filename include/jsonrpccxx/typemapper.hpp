@@ -1,16 +1,19 @@
 #pragma once
 
 #include "common.hpp"
+#include "deadline.hpp"
+#include "handle.hpp"
 #include "nlohmann/json.hpp"
+#include "writer.hpp"
 #include <functional>
 #include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace jsonrpccxx {
-  typedef std::function<json(const json &)> MethodHandle;
-  typedef std::function<void(const json &)> NotificationHandle;
-
   // Workaround due to forbidden partial template function specialisation
   template <typename T>
   struct type {};
@@ -62,6 +65,36 @@ namespace jsonrpccxx {
     }
   }
 
+  // JSON schema of the values accepted for T, used to describe handles
+  inline json schema_of(json::value_t t) {
+    switch (t) {
+    case json::value_t::number_integer:
+      return {{"type", "integer"}};
+    case json::value_t::number_unsigned:
+      return {{"type", "integer"}, {"minimum", 0}};
+    case json::value_t::number_float:
+      return {{"type", "number"}};
+    case json::value_t::boolean:
+      return {{"type", "boolean"}};
+    case json::value_t::string:
+      return {{"type", "string"}};
+    case json::value_t::array:
+      return {{"type", "array"}};
+    case json::value_t::object:
+      return {{"type", "object"}};
+    default:
+      return {{"type", "null"}};
+    }
+  }
+  template <typename T>
+  inline json GetSchema(type<T>) {
+    return schema_of(GetType(type<T>()));
+  }
+  template <typename T>
+  inline json GetSchema(type<std::vector<T>>) {
+    return {{"type", "array"}, {"items", GetSchema(type<typename std::decay<T>::type>())}};
+  }
+
   template <typename T>
   inline void check_param_type(size_t index, const json &x, json::value_t expectedType, typename std::enable_if<std::is_arithmetic<T>::value>::type * = 0) {
     if (expectedType == json::value_t::number_unsigned && x.type() == json::value_t::number_integer) {
@@ -88,41 +121,228 @@ namespace jsonrpccxx {
     }
   }
 
-  template <typename ReturnType, typename... ParamTypes, std::size_t... index>
-  MethodHandle createMethodHandle(std::function<ReturnType(ParamTypes...)> method, std::index_sequence<index...>) {
-    MethodHandle handle = [method](const json &params) -> json {
-      size_t actualSize = params.size();
-      size_t formalSize = sizeof...(ParamTypes);
-      // TODO: add lenient mode for backwards compatible additional params
+  // Param policies, chosen when binding a handle. Arity checks are generated per policy at compile time.
+  // The call must pass exactly as many params as the function takes
+  struct StrictParams {
+    static constexpr size_t optional = 0;
+    static constexpr bool extra = false;
+  };
+  // Additional params are ignored, e.g. sent by newer clients during a rolling deployment
+  struct LenientParams {
+    static constexpr size_t optional = 0;
+    static constexpr bool extra = true;
+  };
+  // The trailing params may be omitted and take the given values
+  template <typename... T>
+  struct DefaultParams {
+    static constexpr size_t optional = sizeof...(T);
+    static constexpr bool extra = false;
+    std::tuple<T...> values;
+  };
+  template <typename... T>
+  DefaultParams<typename std::decay<T>::type...> WithDefaults(T &&... values) {
+    return {std::make_tuple(std::forward<T>(values)...)};
+  }
+
+  template <typename T>
+  struct is_param_policy : std::false_type {};
+  template <>
+  struct is_param_policy<StrictParams> : std::true_type {};
+  template <>
+  struct is_param_policy<LenientParams> : std::true_type {};
+  template <typename... T>
+  struct is_param_policy<DefaultParams<T...>> : std::true_type {};
+
+  template <typename Policy, typename... ParamTypes, std::size_t... index>
+  inline void check_arguments(const json &params, std::index_sequence<index...>) {
+    constexpr size_t formalSize = sizeof...(ParamTypes);
+    constexpr size_t requiredSize = formalSize - Policy::optional;
+    size_t actualSize = params.size();
+    if constexpr (requiredSize == formalSize && !Policy::extra) {
       if (actualSize != formalSize) {
         throw JsonRpcException(invalid_params, "invalid parameter: expected " + std::to_string(formalSize) + " argument(s), but found " + std::to_string(actualSize));
       }
       (check_param_type<typename std::decay<ParamTypes>::type>(index, params[index], GetType(type<typename std::decay<ParamTypes>::type>())), ...);
-      return method(params[index].get<typename std::decay<ParamTypes>::type>()...);
-    };
-    return handle;
+    } else {
+      if (actualSize < requiredSize || (!Policy::extra && actualSize > formalSize)) {
+        std::string expected = Policy::extra ? "at least " + std::to_string(requiredSize) : std::to_string(requiredSize) + " to " + std::to_string(formalSize);
+        throw JsonRpcException(invalid_params, "invalid parameter: expected " + expected + " argument(s), but found " + std::to_string(actualSize));
+      }
+      ((index < actualSize ? check_param_type<typename std::decay<ParamTypes>::type>(index, params[index], GetType(type<typename std::decay<ParamTypes>::type>()))
+                           : void()),
+       ...);
+    }
+  }
+
+  template <typename... ParamTypes, std::size_t... index>
+  inline void check_params(const json &params, std::index_sequence<index...> sequence) {
+    check_arguments<StrictParams, ParamTypes...>(params, sequence);
+  }
+
+  // Converts a param the handler owns, strings and arrays are moved out of the request instead of copied
+  template <typename T>
+  struct param_mover {
+    static T take(json &value) { return value.get<T>(); }
+  };
+  template <>
+  struct param_mover<json> {
+    static json take(json &value) { return std::move(value); }
+  };
+  template <>
+  struct param_mover<std::string> {
+    static std::string take(json &value) {
+      if (!value.is_string())
+        return value.get<std::string>();
+      return std::move(value.get_ref<std::string &>());
+    }
+  };
+  template <typename T>
+  struct param_mover<std::vector<T>> {
+    static std::vector<T> take(json &value) {
+      if (!value.is_array())
+        return value.get<std::vector<T>>();
+      std::vector<T> result;
+      result.reserve(value.size());
+      for (json &element : value)
+        result.push_back(param_mover<T>::take(element));
+      return result;
+    }
+  };
+
+  // Params passed as rvalue are owned by the handle and may be moved from
+  template <typename T, typename Params>
+  inline T convert_param(Params &&params, size_t index) {
+    if constexpr (std::is_lvalue_reference<Params>::value) {
+      return params[index].template get<T>();
+    } else {
+      return param_mover<T>::take(params[index]);
+    }
+  }
+
+  // Calls function with the converted params, Write() serializes results with a result_writer without building a json value
+  template <typename ReturnType, typename F, typename Policy, typename Sequence, typename... ParamTypes>
+  struct HandleBinding;
+  template <typename ReturnType, typename F, typename Policy, std::size_t... index, typename... ParamTypes>
+  struct HandleBinding<ReturnType, F, Policy, std::index_sequence<index...>, ParamTypes...> {
+    static_assert(Policy::optional <= sizeof...(ParamTypes), "more default values than params");
+    static constexpr size_t optional_params = Policy::optional;
+    F function;
+    Policy policy;
+
+    template <typename Params>
+    ReturnType operator()(Params &&params) const {
+      return call(std::forward<Params>(params));
+    }
+    template <typename Params>
+    void Write(Params &&params, std::string &out) const {
+      if constexpr (std::is_void<ReturnType>::value) {
+        call(std::forward<Params>(params));
+      } else {
+        write_result<typename std::decay<ReturnType>::type>(out, call(std::forward<Params>(params)));
+      }
+    }
+    // Schemas of the params and, unless it is a notification, of the result
+    static json Describe() {
+      json description = {{"params", {GetSchema(type<typename std::decay<ParamTypes>::type>())...}}};
+      if constexpr (!std::is_void<ReturnType>::value) {
+        description["result"] = GetSchema(type<typename std::decay<ReturnType>::type>());
+      }
+      return description;
+    }
+
+  private:
+    static constexpr size_t required = sizeof...(ParamTypes) - Policy::optional;
+
+    template <typename Params>
+    ReturnType call(Params &&params) const {
+      check_arguments<Policy, ParamTypes...>(params, std::index_sequence<index...>{});
+      [[maybe_unused]] size_t actualSize = params.size();
+      return function(argument<index>(std::forward<Params>(params), actualSize)...);
+    }
+
+    template <size_t I, typename Params>
+    typename std::decay<typename std::tuple_element<I, std::tuple<ParamTypes...>>::type>::type argument(Params &&params, [[maybe_unused]] size_t actualSize) const {
+      typedef typename std::decay<typename std::tuple_element<I, std::tuple<ParamTypes...>>::type>::type T;
+      if constexpr (I < required) {
+        return convert_param<T>(std::forward<Params>(params), I);
+      } else {
+        if (I < actualSize)
+          return convert_param<T>(std::forward<Params>(params), I);
+        return T(std::get<I - required>(policy.values));
+      }
+    }
+  };
+
+  // A trailing CancellationToken param gets the token of the call instead of a request param
+  template <typename... ParamTypes>
+  struct takes_token : std::false_type {};
+  template <typename Last>
+  struct takes_token<Last> : std::is_same<typename std::decay<Last>::type, CancellationToken> {};
+  template <typename First, typename Second, typename... Rest>
+  struct takes_token<First, Second, Rest...> : takes_token<Second, Rest...> {};
+
+  template <typename F>
+  struct TokenForwarder {
+    F function;
+    template <typename... Args>
+    decltype(auto) operator()(Args &&... args) const {
+      return function(std::forward<Args>(args)..., CancellationToken(CancellationToken::Current()));
+    }
+  };
+
+  // Binds the params except the trailing token, index enumerates them
+  template <typename ReturnType, typename F, typename Policy, typename... ParamTypes, std::size_t... index>
+  HandleBinding<ReturnType, TokenForwarder<F>, Policy, std::index_sequence<index...>, typename std::tuple_element<index, std::tuple<ParamTypes...>>::type...>
+  bindWithToken(F method, Policy policy, std::index_sequence<index...>) {
+    return {TokenForwarder<F>{std::move(method)}, std::move(policy)};
+  }
+
+  // Binds any callable taking ParamTypes directly into the handle, so calls don't pass through another std::function
+  template <typename ReturnType, typename... ParamTypes, typename F, typename Policy = StrictParams>
+  MethodHandle bindMethodHandle(F method, Policy policy = {}) {
+    if constexpr (takes_token<ParamTypes...>::value) {
+      return bindWithToken<ReturnType, F, Policy, ParamTypes...>(std::move(method), std::move(policy), std::make_index_sequence<sizeof...(ParamTypes) - 1>());
+    } else {
+      return HandleBinding<ReturnType, F, Policy, std::index_sequence_for<ParamTypes...>, ParamTypes...>{std::move(method), std::move(policy)};
+    }
+  }
+
+  template <typename... ParamTypes, typename F, typename Policy = StrictParams>
+  NotificationHandle bindNotificationHandle(F method, Policy policy = {}) {
+    if constexpr (takes_token<ParamTypes...>::value) {
+      return bindWithToken<void, F, Policy, ParamTypes...>(std::move(method), std::move(policy), std::make_index_sequence<sizeof...(ParamTypes) - 1>());
+    } else {
+      return HandleBinding<void, F, Policy, std::index_sequence_for<ParamTypes...>, ParamTypes...>{std::move(method), std::move(policy)};
+    }
+  }
+
+  template <typename Policy>
+  using if_param_policy = typename std::enable_if<is_param_policy<Policy>::value>::type;
+
+  template <typename ReturnType, typename... ParamTypes, std::size_t... index>
+  MethodHandle createMethodHandle(std::function<ReturnType(ParamTypes...)> method, std::index_sequence<index...>) {
+    return bindMethodHandle<ReturnType, ParamTypes...>(std::move(method));
   }
 
   template <typename ReturnType, typename... ParamTypes>
   MethodHandle methodHandle(std::function<ReturnType(ParamTypes...)> method) {
-    return createMethodHandle(method, std::index_sequence_for<ParamTypes...>{});
+    return createMethodHandle(std::move(method), std::index_sequence_for<ParamTypes...>{});
   }
 
-  template <typename ReturnType, typename... ParamTypes>
-  MethodHandle GetHandle(std::function<ReturnType(ParamTypes...)> f) {
-    return methodHandle(f);
+  template <typename ReturnType, typename... ParamTypes, typename Policy = StrictParams, typename = if_param_policy<Policy>>
+  MethodHandle GetHandle(std::function<ReturnType(ParamTypes...)> f, Policy policy = {}) {
+    return bindMethodHandle<ReturnType, ParamTypes...>(std::move(f), std::move(policy));
   }
   // Mapping for c-style function pointers
-  template <typename ReturnType, typename... ParamTypes>
-  MethodHandle GetHandle(ReturnType (*f)(ParamTypes...)) {
-    return GetHandle(std::function<ReturnType(ParamTypes...)>(f));
+  template <typename ReturnType, typename... ParamTypes, typename Policy = StrictParams, typename = if_param_policy<Policy>>
+  MethodHandle GetHandle(ReturnType (*f)(ParamTypes...), Policy policy = {}) {
+    return bindMethodHandle<ReturnType, ParamTypes...>(f, std::move(policy));
   }
 
-  inline MethodHandle GetUncheckedHandle(std::function<json(const json&)> f) {
-    MethodHandle handle = [f](const json &params) -> json {
-      return f(params);
-    };
-    return handle;
+  // f is called with the raw params, any callable returning json is accepted
+  template <typename F>
+  MethodHandle GetUncheckedHandle(F &&f) {
+    return MethodHandle(std::forward<F>(f));
   }
 
   //
@@ -130,89 +350,60 @@ namespace jsonrpccxx {
   //
   template <typename... ParamTypes, std::size_t... index>
   NotificationHandle createNotificationHandle(std::function<void(ParamTypes...)> method, std::index_sequence<index...>) {
-    NotificationHandle handle = [method](const json &params) -> void {
-      size_t actualSize = params.size();
-      size_t formalSize = sizeof...(ParamTypes);
-      // TODO: add lenient mode for backwards compatible additional params
-      // if ((!allow_unkown_params && actualSize != formalSize) || (allow_unkown_params && actualSize < formalSize)) {
-      if (actualSize != formalSize) {
-        throw JsonRpcException(invalid_params, "invalid parameter: expected " + std::to_string(formalSize) + " argument(s), but found " + std::to_string(actualSize));
-      }
-      (check_param_type<typename std::decay<ParamTypes>::type>(index, params[index], GetType(type<typename std::decay<ParamTypes>::type>())), ...);
-      method(params[index].get<typename std::decay<ParamTypes>::type>()...);
-    };
-    return handle;
+    return bindNotificationHandle<ParamTypes...>(std::move(method));
   }
 
   template <typename... ParamTypes>
   NotificationHandle notificationHandle(std::function<void(ParamTypes...)> method) {
-    return createNotificationHandle(method, std::index_sequence_for<ParamTypes...>{});
+    return createNotificationHandle(std::move(method), std::index_sequence_for<ParamTypes...>{});
   }
 
-  template <typename... ParamTypes>
-  NotificationHandle GetHandle(std::function<void(ParamTypes...)> f) {
-    return notificationHandle(f);
+  template <typename... ParamTypes, typename Policy = StrictParams, typename = if_param_policy<Policy>>
+  NotificationHandle GetHandle(std::function<void(ParamTypes...)> f, Policy policy = {}) {
+    return bindNotificationHandle<ParamTypes...>(std::move(f), std::move(policy));
   }
 
-  template <typename... ParamTypes>
-  NotificationHandle GetHandle(void (*f)(ParamTypes...)) {
-    return GetHandle(std::function<void(ParamTypes...)>(f));
+  template <typename... ParamTypes, typename Policy = StrictParams, typename = if_param_policy<Policy>>
+  NotificationHandle GetHandle(void (*f)(ParamTypes...), Policy policy = {}) {
+    return bindNotificationHandle<ParamTypes...>(f, std::move(policy));
   }
 
-  inline NotificationHandle GetUncheckedNotificationHandle(std::function<void(const json&)> f) {
-    NotificationHandle handle = [f](const json &params) -> void {
-      f(params);
-    };
-    return handle;
+  template <typename F>
+  NotificationHandle GetUncheckedNotificationHandle(F &&f) {
+    return NotificationHandle(std::forward<F>(f));
   }
 
-  template <typename T, typename ReturnType, typename... ParamTypes>
-  MethodHandle methodHandle(ReturnType (T::*method)(ParamTypes...), T &instance) {
-    std::function<ReturnType(ParamTypes...)> function = [&instance, method](ParamTypes &&... params) -> ReturnType {
-      return (instance.*method)(std::forward<ParamTypes>(params)...);
-    };
-    return methodHandle(function);
+  template <typename T, typename ReturnType, typename... ParamTypes, typename Policy = StrictParams, typename = if_param_policy<Policy>>
+  MethodHandle GetHandle(ReturnType (T::*method)(ParamTypes...), T &instance, Policy policy = {}) {
+    auto function = [&instance, method](ParamTypes &&... params) -> ReturnType { return (instance.*method)(std::forward<ParamTypes>(params)...); };
+    return bindMethodHandle<ReturnType, ParamTypes...>(function, std::move(policy));
   }
 
-  template <typename T, typename... ParamTypes>
-  NotificationHandle notificationHandle(void (T::*method)(ParamTypes...), T &instance) {
-    std::function<void(ParamTypes...)> function = [&instance, method](ParamTypes &&... params) -> void {
-      return (instance.*method)(std::forward<ParamTypes>(params)...);
-    };
-    return notificationHandle(function);
+  template <typename T, typename... ParamTypes, typename Policy = StrictParams, typename = if_param_policy<Policy>>
+  NotificationHandle GetHandle(void (T::*method)(ParamTypes...), T &instance, Policy policy = {}) {
+    auto function = [&instance, method](ParamTypes &&... params) -> void { (instance.*method)(std::forward<ParamTypes>(params)...); };
+    return bindNotificationHandle<ParamTypes...>(function, std::move(policy));
+  }
+
+  template <typename T, typename ReturnType, typename... ParamTypes, typename Policy = StrictParams, typename = if_param_policy<Policy>>
+  MethodHandle GetHandle(ReturnType (T::*method)(ParamTypes...) const, const T &instance, Policy policy = {}) {
+    auto function = [&instance, method](ParamTypes &&... params) -> ReturnType { return (instance.*method)(std::forward<ParamTypes>(params)...); };
+    return bindMethodHandle<ReturnType, ParamTypes...>(function, std::move(policy));
+  }
+
+  template <typename T, typename... ParamTypes, typename Policy = StrictParams, typename = if_param_policy<Policy>>
+  NotificationHandle GetHandle(void (T::*method)(ParamTypes...) const, const T &instance, Policy policy = {}) {
+    auto function = [&instance, method](ParamTypes &&... params) -> void { (instance.*method)(std::forward<ParamTypes>(params)...); };
+    return bindNotificationHandle<ParamTypes...>(function, std::move(policy));
   }
 
   template <typename T, typename ReturnType, typename... ParamTypes>
-  MethodHandle GetHandle(ReturnType (T::*method)(ParamTypes...), T &instance) {
-    std::function<ReturnType(ParamTypes...)> function = [&instance, method](ParamTypes &&... params) -> ReturnType {
-      return (instance.*method)(std::forward<ParamTypes>(params)...);
-    };
-    return GetHandle(function);
+  MethodHandle methodHandle(ReturnType (T::*method)(ParamTypes...), T &instance) {
+    return GetHandle(method, instance);
   }
 
   template <typename T, typename... ParamTypes>
-  NotificationHandle GetHandle(void (T::*method)(ParamTypes...), T &instance) {
-    std::function<void(ParamTypes...)> function = [&instance, method](ParamTypes &&... params) -> void {
-      return (instance.*method)(std::forward<ParamTypes>(params)...);
-    };
-    return GetHandle(function);
-  }
-
-  template<typename T, typename ReturnType, typename... ParamTypes>
-  MethodHandle GetHandle(ReturnType (T::*method)(ParamTypes...) const, const T &instance)
-  {
-      std::function<ReturnType(ParamTypes...)> function = [&instance, method](ParamTypes &&...params) -> ReturnType {
-          return (instance.*method)(std::forward<ParamTypes>(params)...);
-      };
-      return GetHandle(function);
-  }
-
-  template<typename T, typename... ParamTypes>
-  NotificationHandle GetHandle(void (T::*method)(ParamTypes...) const, const T &instance)
-  {
-      std::function<void(ParamTypes...)> function = [&instance, method](ParamTypes &&...params) -> void {
-          return (instance.*method)(std::forward<ParamTypes>(params)...);
-      };
-      return GetHandle(function);
+  NotificationHandle notificationHandle(void (T::*method)(ParamTypes...), T &instance) {
+    return GetHandle(method, instance);
   }
 }
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "common.hpp"
+#include <charconv>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jsonrpccxx {
+  // Serializes results straight into the response, bypassing the json DOM. Opt in for a type by specializing
+  //   template <> struct result_writer<T> { static void write(std::string &out, const T &value); };
+  // The output must equal json(value).dump(). Types without a writer are converted via to_json.
+  template <typename T, typename = void>
+  struct result_writer;
+
+  template <typename T, typename = void>
+  struct has_result_writer : std::false_type {};
+  template <typename T>
+  struct has_result_writer<T, std::void_t<decltype(result_writer<T>::write(std::declval<std::string &>(), std::declval<const T &>()))>> : std::true_type {};
+
+  template <>
+  struct result_writer<bool> {
+    static void write(std::string &out, bool value) { out += value ? "true" : "false"; }
+  };
+
+  template <typename T>
+  struct result_writer<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+    static void write(std::string &out, T value) {
+      char buffer[24];
+      auto end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+      out.append(buffer, static_cast<size_t>(end - buffer));
+    }
+  };
+
+  // Same shortest round-trip representation as json::dump(), json stores all floating point numbers as double
+  template <typename T>
+  struct result_writer<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    static void write(std::string &out, T value) {
+      auto number = static_cast<double>(value);
+      if (!std::isfinite(number)) {
+        out += "null";
+        return;
+      }
+      char buffer[64];
+      char *end = nlohmann::detail::to_chars(buffer, buffer + sizeof(buffer), number);
+      out.append(buffer, static_cast<size_t>(end - buffer));
+    }
+  };
+
+  template <>
+  struct result_writer<std::string> {
+    static void write(std::string &out, const std::string &value) {
+      for (char c : value) {
+        // Escaping and UTF-8 validation are left to json::dump()
+        if (c < 0x20 || c == 0x7f || c == '"' || c == '\\') {
+          out += json(value).dump();
+          return;
+        }
+      }
+      out += '"';
+      out += value;
+      out += '"';
+    }
+  };
+
+  template <typename T>
+  struct result_writer<std::vector<T>, typename std::enable_if<has_result_writer<T>::value>::type> {
+    static void write(std::string &out, const std::vector<T> &values) {
+      out += '[';
+      for (size_t i = 0; i < values.size(); i++) {
+        if (i > 0)
+          out += ',';
+        result_writer<T>::write(out, values[i]);
+      }
+      out += ']';
+    }
+  };
+
+  // Appends value.dump() without the intermediate string
+  inline void write_json(std::string &out, const json &value) {
+    nlohmann::detail::serializer<json> serializer(nlohmann::detail::output_adapter<char, std::string>(out), ' ');
+    serializer.dump(value, false, false, 0);
+  }
+
+  template <typename T>
+  inline void write_result(std::string &out, const T &value) {
+    if constexpr (has_result_writer<T>::value) {
+      result_writer<T>::write(out, value);
+    } else if constexpr (std::is_same<T, json>::value) {
+      write_json(out, value);
+    } else {
+      out += json(value).dump();
+    }
+  }
+} // namespace jsonrpccxx
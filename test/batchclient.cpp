@@ -71,4 +71,80 @@ TEST_CASE("batchclient") {
   CHECK_THROWS_WITH(client.BatchCall(r), "-32700: invalid JSON response from server: expected array");
   c.raw_response = "somestring";
   CHECK_THROWS_WITH(client.BatchCall(r), "-32700: invalid JSON response from server: [json.exception.parse_error.101] parse error at line 1, column 1: syntax error while parsing value - invalid literal; last read: 's'");
-}
\ No newline at end of file
+}
+TEST_CASE("lazy batchresponse") {
+  json elements = {{{"jsonrpc", "2.0"}, {"id", "1"}, {"result", "some\"result]string"}},
+                   {{"jsonrpc", "2.0"}, {"id", "2"}, {"result", 33}},
+                   {{"jsonrpc", "2.0"}, {"id", "3"}, {"error", {{"code", -111}, {"message", "the error message"}}}},
+                   {{"jsonrpc", "2.0"}, {"id", nullptr}, {"error", {{"code", -112}, {"message", "the error message"}}}},
+                   3,
+                   {{"id", 4}, {"result", {{"id", 5}, {"error", "nested"}}}},
+                   "text"};
+  LazyBatchResponse br(elements.dump(2));
+
+  CHECK(br.HasErrors());
+  CHECK(br.Size() == 7);
+  CHECK(br.Get<string>("1") == "some\"result]string");
+  REQUIRE_THROWS_WITH(br.Get<string>(1), "-32700: no result found for id 1");
+  CHECK(br.Get<int>("2") == 33);
+  REQUIRE_THROWS_WITH(br.Get<int>("1"), "-32700: invalid return type: [json.exception.type_error.302] type must be number, but is string");
+  REQUIRE_THROWS_WITH(br.Get<string>("3"), "-111: the error message");
+  REQUIRE_THROWS_WITH(br.Get<string>(nullptr), "-32700: no result found for id null");
+  CHECK(br.Get<json>(4) == json{{"id", 5}, {"error", "nested"}});
+  REQUIRE_THROWS_WITH(br.Get<int>(5), "-32700: no result found for id 5");
+
+  CHECK(br.GetInvalidIndexes() == vector<size_t>{3, 4, 6});
+  CHECK(br.GetElement(3)["error"]["code"] == -112);
+  CHECK(br.GetElement(4) == 3);
+  CHECK(br.GetElement(6) == "text");
+
+  CHECK(LazyBatchResponse(" [ ] ").Size() == 0);
+  CHECK_THROWS_WITH(LazyBatchResponse("{}"), "-32700: invalid JSON response from server: expected array");
+  CHECK_THROWS_WITH(LazyBatchResponse(R"([{"id":1,"result":"open])"), "-32700: invalid JSON response from server: unterminated string");
+  CHECK_THROWS_WITH(LazyBatchResponse(R"([{"id":1,"result":1})"), "-32700: invalid JSON response from server: unexpected end of the batch");
+  CHECK_THROWS_WITH(LazyBatchResponse(R"([{"id":1,"result":1}]])"), "-32700: invalid JSON response from server: unexpected data after the batch");
+  LazyBatchResponse malformed(R"([{"id":1,"result":tru}])");
+  CHECK_THROWS_AS(malformed.Get<bool>(1), JsonRpcException);
+}
+
+TEST_CASE("lazy batchclient") {
+  TestClientConnector c;
+  BatchClient client(c);
+  c.SetBatchResult({TestClientConnector::BuildResult("result1", 1), TestClientConnector::BuildResult(33, 2)});
+
+  BatchRequest r;
+  r.AddMethodCall(1, "some_method", {"value1"});
+  r.AddMethodCall(2, "some_method", {"value2"});
+  LazyBatchResponse response = client.LazyBatchCall(r);
+  CHECK(!response.HasErrors());
+  CHECK(response.Get<string>(1) == "result1");
+  CHECK(response.Get<int>(2) == 33);
+  CHECK(c.request.size() == 2);
+}
+
+TEST_CASE("batchrequest is serialized as calls are added") {
+  BatchRequest br;
+  CHECK(br.Serialize() == "[]");
+  CHECK(br.Build() == json::array());
+  br.Reserve(1024)
+      .AddMethodCall(1, "m\"1", {"v", 2, json{{"k", nullptr}}})
+      .AddNamedMethodCall("2", "m2", {{"b", 1}, {"a", {1, 2}}})
+      .AddNotificationCall("n1")
+      .AddNamedNotificationCall("n2", {{"p", 1.5}});
+  CHECK(br.Size() == 4);
+
+  json expected = {{{"id", 1}, {"jsonrpc", "2.0"}, {"method", "m\"1"}, {"params", {"v", 2, {{"k", nullptr}}}}},
+                   {{"id", "2"}, {"jsonrpc", "2.0"}, {"method", "m2"}, {"params", {{"a", {1, 2}}, {"b", 1}}}},
+                   {{"jsonrpc", "2.0"}, {"method", "n1"}, {"params", json::array()}},
+                   {{"jsonrpc", "2.0"}, {"method", "n2"}, {"params", {{"p", 1.5}}}}};
+  CHECK(br.Serialize() == expected.dump());
+  CHECK(br.Build() == expected);
+  br.AddMethodCall(3, "m3");
+  CHECK(br.Build().size() == 5);
+
+  TestClientConnector c;
+  BatchClient client(c);
+  c.SetBatchResult(json::array({TestClientConnector::BuildResult(1, 1)}));
+  CHECK(client.BatchCall(br).Get<int>(1) == 1);
+  CHECK(c.request == br.Build());
+}
@@ -0,0 +1,108 @@
+#include "doctest/doctest.h"
+#include "testserverconnector.hpp"
+#include <chrono>
+#include <jsonrpccxx/cache.hpp>
+#include <jsonrpccxx/server.hpp>
+#include <thread>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+TEST_CASE("result cache lookup and eviction") {
+  ResultCache cache(CachePolicy{chrono::hours(1), 1});
+  string out;
+  CHECK(!cache.Get({1, 2}, out));
+  cache.Put({1, 2}, "3");
+  CHECK(cache.Get({1, 2}, out));
+  CHECK(out == "3");
+  CHECK(!cache.Get({2, 1}, out));
+
+  cache.Put({2, 1}, "5");
+  CHECK(cache.Get({2, 1}, out));
+  CHECK(!cache.Get({1, 2}, out));
+  CHECK(out == "35");
+
+  CacheStatistics s = cache.Statistics();
+  CHECK(s.hits == 2);
+  CHECK(s.misses == 3);
+  CHECK(s.entries == 1);
+
+  cache.Invalidate({2, 1});
+  CHECK(cache.Statistics().entries == 0);
+}
+
+TEST_CASE("result cache keeps most recently used entries") {
+  ResultCache cache(CachePolicy{chrono::hours(1), 64});
+  for (int i = 0; i < 1000; i++) {
+    cache.Put({i}, to_string(i));
+    string out;
+    CHECK(cache.Get({0}, out));
+  }
+  CHECK(cache.Statistics().entries <= 64);
+  cache.Clear();
+  CHECK(cache.Statistics().entries == 0);
+}
+
+TEST_CASE("result cache expiry") {
+  ResultCache cache(CachePolicy{chrono::milliseconds(1), 10});
+  cache.Put({"a"}, "1");
+  this_thread::sleep_for(chrono::milliseconds(5));
+  string out;
+  CHECK(!cache.Get({"a"}, out));
+  CHECK(cache.Statistics().entries == 0);
+}
+
+class ProductService {
+public:
+  ProductService() : calls(0) {}
+  json GetProduct(const string &id) {
+    calls++;
+    if (id.empty())
+      throw JsonRpcException(-32001, "empty id");
+    return {{"id", id}, {"calls", calls}};
+  }
+  int calls;
+};
+
+TEST_CASE("cached methods") {
+  JsonRpc2Server server;
+  TestServerConnector connector(server);
+  ProductService service;
+  MethodOptions options;
+  options.cache = CachePolicy{chrono::hours(1), 100};
+  REQUIRE(server.Add("GetProduct", GetHandle(&ProductService::GetProduct, service), {"id"}, options));
+
+  connector.CallMethod(1, "GetProduct", {"a"});
+  CHECK(connector.VerifyMethodResult(1) == json{{"id", "a"}, {"calls", 1}});
+  connector.CallMethod(2, "GetProduct", {{"id", "a"}});
+  CHECK(connector.VerifyMethodResult(2) == json{{"id", "a"}, {"calls", 1}});
+  connector.CallMethod(3, "GetProduct", {"b"});
+  CHECK(connector.VerifyMethodResult(3) == json{{"id", "b"}, {"calls", 2}});
+  CHECK(service.calls == 2);
+
+  connector.CallMethod(4, "GetProduct", {""});
+  connector.VerifyMethodError(-32001, "empty id", 4);
+  connector.CallMethod(5, "GetProduct", {""});
+  connector.VerifyMethodError(-32001, "empty id", 5);
+  CHECK(service.calls == 4);
+
+  CHECK(server.InvalidateCache("GetProduct", {{"id", "a"}}));
+  connector.CallMethod(6, "GetProduct", {"a"});
+  CHECK(connector.VerifyMethodResult(6) == json{{"id", "a"}, {"calls", 5}});
+  connector.CallMethod(7, "GetProduct", {"b"});
+  CHECK(connector.VerifyMethodResult(7) == json{{"id", "b"}, {"calls", 2}});
+
+  CHECK(server.InvalidateCache("GetProduct"));
+  CHECK(!server.InvalidateCache("unknown"));
+  connector.CallMethod(8, "GetProduct", {"b"});
+  CHECK(connector.VerifyMethodResult(8) == json{{"id", "b"}, {"calls", 6}});
+
+  auto stats = server.GetCacheStatistics();
+  REQUIRE(stats.size() == 1);
+  CHECK(stats["GetProduct"].hits == 2);
+  CHECK(stats["GetProduct"].misses == 6);
+  CHECK(stats["GetProduct"].entries == 1);
+
+  server.InvalidateCaches();
+  CHECK(server.GetCacheStatistics()["GetProduct"].entries == 0);
+}
@@ -2,6 +2,9 @@
 #include "testclientconnector.hpp"
 #include <iostream>
 #include <jsonrpccxx/client.hpp>
+#include <limits>
+#include <set>
+#include <thread>
 
 using namespace std;
 using namespace jsonrpccxx;
@@ -275,3 +278,128 @@ TEST_CASE_FIXTURE(F, "v1_notification_call_params_byposition") {
 }*/
 
 // TODO: test cases with return type mapping and param mapping for v1/v2 method and notification
+
+TEST_CASE_FIXTURE(F, "prepared_calls") {
+  PreparedCall v2 = clientV2.Prepare("some.method_1");
+  c.SetResult(3);
+  CHECK(v2.Call<int>(1, {1, "a\"b", json{{"x", nullptr}}}) == 3);
+  c.VerifyMethodRequest(version::v2, "some.method_1", 1);
+  CHECK(c.request["params"] == json{1, "a\"b", {{"x", nullptr}}});
+
+  CHECK(v2.CallNamed<int>("id", {{"b", 2}, {"a", true}}) == 3);
+  c.VerifyMethodRequest(version::v2, "some.method_1", "id");
+  CHECK(c.request["params"] == json{{"a", true}, {"b", 2}});
+
+  CHECK(v2.Call<int>(2) == 3);
+  c.VerifyMethodRequest(version::v2, "some.method_1", 2);
+  CHECK(c.request["params"] == json::array());
+
+  v2.Notify({4});
+  c.VerifyNotificationRequest(version::v2, "some.method_1");
+  CHECK(c.request["params"] == json{4});
+
+  c.SetError(JsonRpcException(-32602, "invalid params"));
+  CHECK_THROWS_WITH(v2.Call<int>(3, {1}), "-32602: invalid params");
+
+  PreparedCall v1 = clientV1.Prepare("some.method_2");
+  c.SetResult("ok");
+  CHECK(v1.CallNamed<string>(7, {{"a", 1}}) == "ok");
+  c.VerifyMethodRequest(version::v1, "some.method_2", 7);
+  CHECK(c.request["params"] == json{{"a", 1}});
+  v1.NotifyNamed();
+  c.VerifyNotificationRequest(version::v1, "some.method_2");
+  CHECK(c.request["params"] == json::object());
+}
+
+struct Item {
+  Item() : name(), count() {}
+  Item(const string &name, int count) : name(name), count(count) {}
+  string name;
+  int count;
+};
+inline void to_json(json &j, const Item &i) { j = json{{"name", i.name}, {"count", i.count}}; }
+inline void from_json(const json &j, Item &i) {
+  j.at("name").get_to(i.name);
+  j.at("count").get_to(i.count);
+}
+
+TEST_CASE_FIXTURE(F, "remote_methods") {
+  auto store = clientV2.Remote<bool(const Item &, int)>("store");
+  c.SetResult(true);
+  CHECK(store(Item{"a\"b", 2}, 7));
+  c.VerifyMethodRequest(version::v2, "store", 1);
+  CHECK(c.request["params"] == json{{{"name", "a\"b"}, {"count", 2}}, 7});
+  CHECK(store(Item{"c", 1}, 8));
+  c.VerifyMethodRequest(version::v2, "store", 2);
+
+  auto find = clientV2.Remote<Item(const string &, vector<double>)>("find", {"name", "weights"});
+  c.SetResult({{"name", "x"}, {"count", 3}});
+  Item item = find("x", {0.5, 1});
+  CHECK(item.name == "x");
+  CHECK(item.count == 3);
+  CHECK(c.request["params"] == json{{"name", "x"}, {"weights", {0.5, 1.0}}});
+
+  auto none = clientV2.Remote<vector<string>()>("none");
+  c.SetResult(json::array());
+  CHECK(none().empty());
+  CHECK(c.request["params"] == json::array());
+
+  c.SetError(JsonRpcException(-32001, "not found"));
+  CHECK_THROWS_WITH(find("y", {}), "-32001: not found");
+  c.SetResult("wrong");
+  CHECK_THROWS_AS(find("y", {}), json::type_error);
+
+  auto log = clientV1.Remote<void(const string &)>("log", {"message"});
+  log("hello");
+  c.VerifyNotificationRequest(version::v1, "log");
+  CHECK(c.request["params"] == json{{"message", "hello"}});
+
+  CHECK_THROWS_AS(clientV2.Remote<void(int, int)>("pair", {"a"}), std::invalid_argument);
+}
+
+TEST_CASE_FIXTURE(F, "request_ids") {
+  c.SetResult(true);
+  CHECK(clientV2.CallMethod<bool>(numeric_limits<int64_t>::max(), "some.method_1"));
+  c.VerifyMethodRequest(version::v2, "some.method_1", numeric_limits<int64_t>::max());
+
+  string uuid = "123e4567-e89b-12d3-a456-426614174000";
+  CHECK(clientV2.CallMethod<bool>(uuid, "some.method_1"));
+  c.VerifyMethodRequest(version::v2, "some.method_1", uuid);
+  CHECK(StringId(uuid).View() == uuid);
+  string longId(100, 'x');
+  CHECK(StringId(longId).View() == longId);
+  CHECK(StringId(longId) != StringId(uuid));
+
+  PreparedCall call = clientV2.Prepare("some.method_1");
+  CHECK(call.Call<bool>(StringId("quote\"\xc3\xa9")));
+  c.VerifyMethodRequest(version::v2, "some.method_1", "quote\"\xc3\xa9");
+  CHECK_THROWS_AS(call.Call<bool>(StringId("\xff")), json::type_error);
+
+  // Proxies share the id generator of the client
+  int64_t first = clientV2.NextId();
+  auto remote = clientV2.Remote<bool()>("some.method_2");
+  CHECK(remote());
+  c.VerifyMethodRequest(version::v2, "some.method_2", first + 1);
+  CHECK(clientV2.NextId() == first + 2);
+  CHECK(clientV1.NextId() == 1);
+}
+
+TEST_CASE("id generator is thread-safe") {
+  IdGenerator ids;
+  vector<vector<int64_t>> taken(4);
+  vector<thread> threads;
+  for (auto &t : taken) {
+    threads.emplace_back([&ids, &t]() {
+      for (int i = 0; i < 1000; i++)
+        t.push_back(ids.Next());
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+  set<int64_t> unique;
+  for (auto const &t : taken)
+    unique.insert(t.begin(), t.end());
+  CHECK(unique.size() == 4000);
+  CHECK(*unique.begin() == 1);
+  CHECK(*unique.rbegin() == 4000);
+}
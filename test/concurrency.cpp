@@ -0,0 +1,106 @@
+#include "doctest/doctest.h"
+#include "testserverconnector.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <jsonrpccxx/concurrency.hpp>
+#include <jsonrpccxx/server.hpp>
+#include <thread>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+TEST_CASE("concurrency limiter without queue") {
+  ConcurrencyLimiter limiter(ConcurrencyLimit{2});
+  CHECK(limiter.Acquire());
+  CHECK(limiter.Acquire());
+  CHECK(!limiter.Acquire());
+  CHECK(limiter.InFlight() == 2);
+  CHECK(limiter.Rejected() == 1);
+  limiter.Release();
+  CHECK(limiter.Acquire());
+  limiter.Release();
+  limiter.Release();
+  CHECK(limiter.InFlight() == 0);
+}
+
+TEST_CASE("concurrency limiter with queue") {
+  ConcurrencyLimiter limiter(ConcurrencyLimit{1, 1, chrono::milliseconds(2000)});
+  REQUIRE(limiter.Acquire());
+
+  auto waiter = std::async(std::launch::async, [&limiter]() { return limiter.Acquire(); });
+  while (limiter.Queued() == 0)
+    this_thread::yield();
+  CHECK(!limiter.Acquire());
+  CHECK(limiter.Rejected() == 1);
+
+  limiter.Release();
+  CHECK(waiter.get());
+  CHECK(limiter.InFlight() == 1);
+  CHECK(limiter.Queued() == 0);
+  limiter.Release();
+}
+
+TEST_CASE("concurrency limiter queue timeout") {
+  ConcurrencyLimiter limiter(ConcurrencyLimit{1, 4, chrono::milliseconds(10)});
+  REQUIRE(limiter.Acquire());
+  CHECK(!limiter.Acquire());
+  CHECK(limiter.Queued() == 0);
+  CHECK(limiter.Rejected() == 1);
+  limiter.Release();
+}
+
+TEST_CASE("cheap methods keep their latency while an expensive one is saturated") {
+  JsonRpc2Server server;
+  TestServerConnector connector(server);
+  atomic<int> running(0);
+  atomic<int> maxRunning(0);
+  MethodOptions options;
+  options.concurrency = ConcurrencyLimit{2, 0, chrono::milliseconds(0), -32050};
+  REQUIRE(server.Add("expensive", GetUncheckedHandle([&](const json &) -> json {
+                       int current = ++running;
+                       int seen = maxRunning.load();
+                       while (current > seen && !maxRunning.compare_exchange_weak(seen, current)) {
+                       }
+                       this_thread::sleep_for(chrono::milliseconds(50));
+                       running--;
+                       return true;
+                     }),
+                     {}, options));
+  REQUIRE(server.Add("health", GetUncheckedHandle([](const json &) -> json { return "ok"; })));
+
+  atomic<bool> stop(false);
+  atomic<int> rejected(0);
+  atomic<int> succeeded(0);
+  vector<thread> clients;
+  for (int i = 0; i < 8; i++) {
+    clients.emplace_back([&]() {
+      while (!stop) {
+        json response = json::parse(server.HandleRequest(R"({"jsonrpc":"2.0","id":1,"method":"expensive"})"));
+        if (has_key(response, "error")) {
+          CHECK(response["error"]["code"] == -32050);
+          rejected++;
+        } else {
+          succeeded++;
+        }
+      }
+    });
+  }
+
+  auto worst = chrono::nanoseconds(0);
+  for (int i = 0; i < 200; i++) {
+    auto start = chrono::steady_clock::now();
+    connector.CallMethod(i, "health", nullptr);
+    worst = std::max(worst, chrono::steady_clock::now() - start);
+    CHECK(connector.VerifyMethodResult(i) == "ok");
+    this_thread::sleep_for(chrono::microseconds(500));
+  }
+  stop = true;
+  for (auto &t : clients)
+    t.join();
+
+  CHECK(maxRunning <= 2);
+  CHECK(succeeded > 0);
+  CHECK(rejected > 0);
+  CHECK(worst < chrono::milliseconds(50));
+}
@@ -0,0 +1,134 @@
+#include "doctest/doctest.h"
+#include "testclientconnector.hpp"
+#include "testserverconnector.hpp"
+#include <atomic>
+#include <chrono>
+#include <jsonrpccxx/client.hpp>
+#include <jsonrpccxx/deadline.hpp>
+#include <jsonrpccxx/server.hpp>
+#include <thread>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+TEST_CASE("cancellation tokens") {
+  CancellationToken none;
+  CHECK(!none.IsCancelled());
+  CHECK(none.Deadline() == DeadlineClock::time_point::max());
+  none.Cancel();
+  CHECK(!none.IsCancelled());
+  CHECK(!CancellationToken::Current().IsCancelled());
+
+  CancellationToken token(DeadlineClock::now() + chrono::hours(1));
+  CancellationToken copy = token;
+  CHECK(!token.IsCancelled());
+  CHECK(token.Remaining() > chrono::minutes(59));
+  copy.Cancel();
+  CHECK(token.IsCancelled());
+  CHECK_THROWS_AS(token.ThrowIfCancelled(), JsonRpcException);
+
+  CancellationToken expired(DeadlineClock::now());
+  CHECK(expired.IsCancelled());
+  CHECK(expired.Remaining() == DeadlineClock::duration::zero());
+
+  {
+    CancellationScope scope(DeadlineClock::now() + chrono::hours(1));
+    CHECK(CancellationToken::Current().Deadline() != DeadlineClock::time_point::max());
+  }
+  CHECK(CancellationToken::Current().Deadline() == DeadlineClock::time_point::max());
+}
+
+static atomic<int> calls(0);
+
+static int echo(int x) {
+  calls++;
+  return x;
+}
+static bool bounded(int x, const CancellationToken &token) { return x > 0 && token.Deadline() != DeadlineClock::time_point::max(); }
+static int nap(int ms) {
+  this_thread::sleep_for(chrono::milliseconds(ms));
+  return ms;
+}
+
+TEST_CASE("handlers receive the token of the call") {
+  JsonRpc2Server server;
+  TestServerConnector connector(server);
+  REQUIRE(server.Add("bounded", GetHandle(&bounded), {"x"}));
+
+  connector.CallMethod(1, "bounded", {1});
+  CHECK(connector.VerifyMethodResult(1) == false);
+  connector.SendRequest({{"id", 2}, {"method", "bounded"}, {"params", {1}}, {"jsonrpc", "2.0"}, {"timeout", 60000}});
+  CHECK(connector.VerifyMethodResult(2) == true);
+  connector.CallMethod(3, "bounded", {1, 2});
+  connector.VerifyMethodError(invalid_params, "invalid parameter: expected 1 argument(s), but found 2", 3);
+
+  server.EnableDiscovery();
+  connector.CallMethod(4, "rpc.discover", json::array());
+  json methods = connector.VerifyMethodResult(4)["methods"];
+  CHECK(methods[0]["params"].size() == 1);
+}
+
+TEST_CASE("calls past their deadline are rejected") {
+  JsonRpc2Server server;
+  TestServerConnector connector(server);
+  MethodOptions patient;
+  patient.deadline = chrono::minutes(1);
+  REQUIRE(server.Add("echo", GetHandle(&echo), {"x"}));
+  REQUIRE(server.Add("patient", GetHandle(&echo), {"x"}, patient));
+  calls = 0;
+
+  server.SetDefaultDeadline(chrono::milliseconds(0));
+  connector.CallMethod(1, "echo", {1});
+  connector.VerifyMethodError(deadline_exceeded, "deadline exceeded before calling echo", 1);
+  connector.CallMethod(2, "patient", {2});
+  CHECK(connector.VerifyMethodResult(2) == 2);
+  CHECK(calls == 1);
+
+  server.SetDefaultDeadline(nullopt);
+  connector.CallMethod(3, "echo", {3});
+  CHECK(connector.VerifyMethodResult(3) == 3);
+  // The timeout of the client shortens the deadline of the method
+  connector.SendRequest({{"id", 4}, {"method", "patient"}, {"params", {4}}, {"jsonrpc", "2.0"}, {"timeout", 0}});
+  connector.VerifyMethodError(deadline_exceeded, "deadline exceeded before calling patient", 4);
+  CHECK(calls == 2);
+
+  connector.SendRequest({{"id", 5}, {"method", "echo"}, {"params", {5}}, {"jsonrpc", "2.0"}, {"timeout", -1}});
+  connector.VerifyMethodError(invalid_request, "invalid request: timeout field must be a non-negative number", 5);
+  connector.SendRequest({{"id", 6}, {"method", "echo"}, {"params", {6}}, {"jsonrpc", "2.0"}, {"timeout", "1s"}});
+  connector.VerifyMethodError(invalid_request, "invalid request: timeout field must be a non-negative number", 6);
+  connector.SendRequest({{"id", 7}, {"method", "echo"}, {"params", {7}}, {"jsonrpc", "2.0"}, {"timeout", 1e300}});
+  CHECK(connector.VerifyMethodResult(7) == 7);
+}
+
+TEST_CASE("calls queued behind others expire") {
+  JsonRpc2Server server;
+  TestServerConnector connector(server);
+  server.AddExecutor("single", MakeBlockingPool(1));
+  MethodOptions options;
+  options.executor = "single";
+  REQUIRE(server.Add("nap", GetHandle(&nap), {"ms"}, options));
+
+  connector.SendRequest({{{"id", 1}, {"method", "nap"}, {"params", {100}}, {"jsonrpc", "2.0"}},
+                         {{"id", 2}, {"method", "nap"}, {"params", {0}}, {"jsonrpc", "2.0"}, {"timeout", 20}},
+                         {{"id", 3}, {"method", "nap"}, {"params", {0}}, {"jsonrpc", "2.0"}, {"timeout", 60000}}});
+  json responses = connector.VerifyBatchResponse();
+  REQUIRE(responses.size() == 3);
+  CHECK(TestServerConnector::VerifyMethodResult(1, responses[0]) == 100);
+  TestServerConnector::VerifyMethodError(deadline_exceeded, "deadline exceeded before calling nap", 2, responses[1]);
+  CHECK(TestServerConnector::VerifyMethodResult(3, responses[2]) == 0);
+}
+
+TEST_CASE("client sends its timeout") {
+  TestClientConnector c;
+  JsonRpcClient client(c, version::v2);
+  c.SetResult(true);
+  client.CallMethod<json>(1, "some.method");
+  CHECK(!has_key(c.request, "timeout"));
+
+  client.SetTimeout(chrono::milliseconds(250));
+  c.SetResult(true);
+  client.CallMethod<json>(2, "some.method");
+  CHECK(c.request["timeout"] == 250);
+  client.CallNotification("some.notification");
+  CHECK(!has_key(c.request, "timeout"));
+}
@@ -81,4 +81,38 @@ TEST_CASE("invalid param types") {
     CHECK_THROWS_WITH(d.InvokeMethod("some method", {"string1", "string2"}), "-32602: invalid parameter: must be unsigned integer, but is string for parameter 0");
 }
 
-// TODO: avoid signed, unsigned bool invocations
\ No newline at end of file
+// TODO: avoid signed, unsigned bool invocations
+TEST_CASE("owned params are moved into handler arguments") {
+  Dispatcher d;
+  const char *received = nullptr;
+  CHECK(d.Add("take", GetHandle(std::function<size_t(string, vector<string>)>([&received](string s, vector<string> v) {
+                 received = s.data();
+                 return s.size() + v.size();
+               })),
+              {"s", "v"}));
+  json params = {string(100, 'x'), {string(100, 'y')}};
+  const char *buffer = params[0].get_ref<const string &>().data();
+  CHECK(d.InvokeMethod("take", params) == 101);
+  CHECK(received != buffer);
+  CHECK(params[0].get_ref<const string &>().size() == 100);
+  CHECK(d.InvokeMethod("take", std::move(params)) == 101);
+  CHECK(received == buffer);
+
+  json named = {{"s", string(100, 'x')}, {"v", json::array()}};
+  buffer = named["s"].get_ref<const string &>().data();
+  CHECK(d.InvokeMethod("take", std::move(named)) == 100);
+  CHECK(received == buffer);
+}
+
+static string label(const string &name, const string &unit, int precision) { return name + "/" + unit + "/" + to_string(precision); }
+
+TEST_CASE("omitted trailing named parameters take defaults") {
+  Dispatcher d;
+  CHECK(d.Add("label", GetHandle(&label, WithDefaults("m", 2)), {"name", "unit", "precision"}));
+  CHECK(d.InvokeMethod("label", {{"name", "x"}}) == "x/m/2");
+  CHECK(d.InvokeMethod("label", {{"name", "x"}, {"unit", "s"}}) == "x/s/2");
+  CHECK(d.InvokeMethod("label", {{"name", "x"}, {"unit", "s"}, {"precision", 0}}) == "x/s/0");
+  CHECK_THROWS_WITH(d.InvokeMethod("label", {{"unit", "s"}}), "-32602: invalid parameter: missing named parameter \"name\"");
+  CHECK_THROWS_WITH(d.InvokeMethod("label", {{"name", "x"}, {"precision", 0}}), "-32602: invalid parameter: missing named parameter \"unit\"");
+  CHECK_THROWS_WITH(d.InvokeMethod("label", {"x", 1}), "-32602: invalid parameter: must be string, but is integer for parameter \"unit\"");
+}
@@ -0,0 +1,130 @@
+#include "doctest/doctest.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <jsonrpccxx/executor.hpp>
+#include <jsonrpccxx/server.hpp>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+TEST_CASE("thread pool runs tasks on its workers") {
+  ThreadPool pool({2, 2});
+  CHECK(pool.Threads() == 2);
+  mutex m;
+  set<thread::id> workers;
+  atomic<int> runs(0);
+  for (int i = 0; i < 100; i++) {
+    pool.Execute([&]() {
+      {
+        lock_guard<mutex> lock(m);
+        workers.insert(this_thread::get_id());
+      }
+      runs++;
+    });
+  }
+  while (runs < 100)
+    this_thread::yield();
+  CHECK(workers.count(this_thread::get_id()) == 0);
+  CHECK(RunOn(pool, []() { return 42; }) == 42);
+  CHECK_THROWS_AS(RunOn(pool, []() -> int { throw std::runtime_error("failed"); }), std::runtime_error);
+}
+
+TEST_CASE("idle workers steal queued tasks") {
+  ThreadPool pool({4, 4});
+  mutex m;
+  set<thread::id> workers;
+  atomic<int> runs(0);
+  // All tasks are queued by one worker on its own queue
+  pool.Execute([&]() {
+    for (int i = 0; i < 8; i++) {
+      pool.Execute([&]() {
+        {
+          lock_guard<mutex> lock(m);
+          workers.insert(this_thread::get_id());
+        }
+        this_thread::sleep_for(chrono::milliseconds(20));
+        runs++;
+      });
+    }
+  });
+  while (runs < 8)
+    this_thread::yield();
+  CHECK(workers.size() > 1);
+  CHECK(pool.Queued() == 0);
+}
+
+TEST_CASE("elastic pool grows with blocking calls and shrinks when idle") {
+  ThreadPool pool({0, 4, chrono::milliseconds(20)});
+  CHECK(pool.Threads() == 0);
+  promise<void> release;
+  shared_future<void> opened = release.get_future().share();
+  atomic<int> started(0);
+  for (int i = 0; i < 4; i++) {
+    pool.Execute([&]() {
+      started++;
+      opened.wait();
+    });
+  }
+  while (started < 4)
+    this_thread::yield();
+  CHECK(pool.Threads() == 4);
+  release.set_value();
+  auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+  while (pool.Threads() > 0 && chrono::steady_clock::now() < deadline)
+    this_thread::sleep_for(chrono::milliseconds(5));
+  CHECK(pool.Threads() == 0);
+  CHECK(RunOn(pool, []() { return this_thread::get_id(); }) != this_thread::get_id());
+}
+
+static thread::id caller;
+static thread::id worker_of_call() { return this_thread::get_id(); }
+static int slow(int value) {
+  this_thread::sleep_for(chrono::milliseconds(100));
+  return value;
+}
+static int fast(int value) { return value; }
+
+TEST_CASE("methods are routed to executors") {
+  JsonRpc2Server server;
+  auto pool = make_shared<ThreadPool>(ThreadPoolOptions{0, 4});
+  server.AddExecutor("db", pool);
+  MethodOptions db;
+  db.executor = "db";
+  MethodOptions cpu;
+  cpu.executor = "cpu";
+  MethodOptions direct;
+  direct.executor = "inline";
+  REQUIRE(server.Add("slow", GetHandle(&slow), {"value"}, db));
+  REQUIRE(server.Add("fast", GetHandle(&fast), {"value"}, cpu));
+  REQUIRE(server.Add("here", GetUncheckedHandle([](const json &) -> json { return worker_of_call() == caller; }), {}, direct));
+  REQUIRE(server.Add("thread", GetUncheckedHandle([](const json &) -> json { return worker_of_call() == caller; }), {}, db));
+
+  caller = this_thread::get_id();
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":1,"method":"thread"})") == R"({"id":1,"jsonrpc":"2.0","result":false})");
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":1,"method":"here"})") == R"({"id":1,"jsonrpc":"2.0","result":true})");
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":2,"method":"fast","params":[7]})") == R"({"id":2,"jsonrpc":"2.0","result":7})");
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":3,"method":"fast","params":["x"]})").find("-32602") != string::npos);
+
+  // The slow calls of a batch run concurrently, responses keep their order
+  auto start = chrono::steady_clock::now();
+  json batch = json::parse(server.HandleRequest(R"([{"jsonrpc":"2.0","id":1,"method":"slow","params":[1]},{"jsonrpc":"2.0","id":2,"method":"fast","params":[2]},)"
+                                                R"({"jsonrpc":"2.0","method":"slow","params":[0]},{"jsonrpc":"2.0","id":3,"method":"slow","params":[3]},)"
+                                                R"({"jsonrpc":"2.0","id":4,"method":"slow","params":[4]},{"jsonrpc":"2.0","id":5,"method":"unknown"}])"));
+  CHECK(chrono::steady_clock::now() - start < chrono::milliseconds(350));
+  REQUIRE(batch.size() == 5);
+  for (int i = 0; i < 4; i++) {
+    CHECK(batch[i]["id"] == i + 1);
+    CHECK(batch[i]["result"] == i + 1);
+  }
+  CHECK(batch[4]["error"]["code"] == method_not_found);
+
+  MethodOptions unknown;
+  unknown.executor = "gpu";
+  CHECK_THROWS_AS(server.Add("other", GetHandle(&fast), {"value"}, unknown), std::invalid_argument);
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":6,"method":"other","params":[1]})").find("-32601") != string::npos);
+}
@@ -0,0 +1,105 @@
+#include "doctest/doctest.h"
+#include "testserverconnector.hpp"
+#include <jsonrpccxx/interceptor.hpp>
+#include <jsonrpccxx/server.hpp>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+static int subtract(int a, int b) { return a - b; }
+static string lastLog;
+static void log_message(const string &message) { lastLog = message; }
+
+struct InterceptedServer {
+  JsonRpc2Server server;
+  TestServerConnector connector;
+  vector<string> trace;
+
+  InterceptedServer() : server(), connector(server), trace() {
+    server.Add("subtract", GetHandle(&subtract), {"a", "b"});
+    server.Add("log", GetHandle(&log_message), {"message"});
+  }
+};
+
+TEST_CASE_FIXTURE(InterceptedServer, "interceptors are called in order around dispatching") {
+  server.AddInterceptor([this](RequestContext &context, const Next &next) {
+    trace.push_back("outer before " + context.method + " " + context.id.dump() + " " + context.params.dump());
+    next();
+    trace.push_back("outer after");
+  });
+  server.AddInterceptor([this](RequestContext &context, const Next &next) {
+    trace.push_back(std::string("inner ") + (context.notification ? "notification" : "method"));
+    next();
+  });
+
+  connector.CallMethod(7, "subtract", {{"a", 5}, {"b", 3}});
+  CHECK(connector.VerifyMethodResult(7) == 2);
+  REQUIRE(trace.size() == 3);
+  CHECK(trace[0] == R"(outer before subtract 7 {"a":5,"b":3})");
+  CHECK(trace[1] == "inner method");
+  CHECK(trace[2] == "outer after");
+
+  trace.clear();
+  connector.CallNotification("log", {{"message", "hello"}});
+  connector.VerifyNotificationResult();
+  CHECK(lastLog == "hello");
+  REQUIRE(trace.size() == 3);
+  CHECK(trace[0] == R"(outer before log null {"message":"hello"})");
+  CHECK(trace[1] == "inner notification");
+}
+
+TEST_CASE_FIXTURE(InterceptedServer, "interceptors may modify params and reject calls") {
+  server.AddInterceptor([](RequestContext &context, const Next &next) {
+    if (context.method == "log")
+      throw JsonRpcException(-32001, "unauthorized");
+    context.params["b"] = 10;
+    next();
+  });
+
+  connector.CallMethod(1, "subtract", {{"a", 5}, {"b", 3}});
+  CHECK(connector.VerifyMethodResult(1) == -5);
+
+  lastLog = "";
+  connector.CallMethod(2, "log", {{"message", "hello"}});
+  connector.VerifyMethodError(-32001, "unauthorized", 2);
+  connector.CallNotification("log", {{"message", "hello"}});
+  connector.VerifyNotificationResult();
+  CHECK(lastLog.empty());
+}
+
+TEST_CASE_FIXTURE(InterceptedServer, "interceptors see dispatching errors") {
+  server.AddInterceptor([this](RequestContext &, const Next &next) {
+    try {
+      next();
+    } catch (JsonRpcException &e) {
+      trace.push_back(e.what());
+      throw;
+    }
+  });
+
+  connector.CallMethod(1, "subtract", {{"a", 5}});
+  connector.VerifyMethodError(-32602, R"(missing named parameter "b")", 1);
+  REQUIRE(trace.size() == 1);
+  CHECK(trace[0] == R"(-32602: invalid parameter: missing named parameter "b")");
+}
+
+TEST_CASE_FIXTURE(InterceptedServer, "composed interceptors") {
+  auto first = [this](RequestContext &, const Next &next) {
+    trace.push_back("first");
+    next();
+  };
+  auto second = [this](RequestContext &context, const Next &next) {
+    trace.push_back("second");
+    context.params["a"] = 20;
+    next();
+  };
+  auto third = [this](RequestContext &, const Next &next) {
+    trace.push_back("third");
+    next();
+  };
+  server.AddInterceptor(ComposeInterceptors(first, second, third));
+
+  connector.CallMethod(1, "subtract", {{"a", 5}, {"b", 3}});
+  CHECK(connector.VerifyMethodResult(1) == 17);
+  CHECK(trace == vector<string>{"first", "second", "third"});
+}
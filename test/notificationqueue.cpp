@@ -0,0 +1,166 @@
+#include "doctest/doctest.h"
+#include <atomic>
+#include <future>
+#include <jsonrpccxx/notificationqueue.hpp>
+#include <jsonrpccxx/server.hpp>
+#include <thread>
+#include <vector>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+TEST_CASE("bounded queue") {
+  BoundedQueue<int> queue(3);
+  CHECK(queue.Capacity() == 4);
+  for (int i = 0; i < 4; i++) {
+    int value = i;
+    CHECK(queue.TryPush(value));
+  }
+  int value = 4;
+  CHECK(!queue.TryPush(value));
+  CHECK(queue.Size() == 4);
+  for (int i = 0; i < 4; i++) {
+    CHECK(queue.TryPop(value));
+    CHECK(value == i);
+  }
+  CHECK(!queue.TryPop(value));
+  CHECK(queue.Size() == 0);
+  CHECK(BoundedQueue<int>(1).Capacity() == 2);
+}
+
+TEST_CASE("bounded queue with concurrent producers and consumers") {
+  BoundedQueue<int> queue(64);
+  atomic<long> sum(0);
+  atomic<int> popped(0);
+  vector<thread> threads;
+  for (int p = 0; p < 4; p++) {
+    threads.emplace_back([&queue]() {
+      for (int i = 1; i <= 10000; i++) {
+        int value = i;
+        while (!queue.TryPush(value))
+          this_thread::yield();
+      }
+    });
+  }
+  for (int c = 0; c < 4; c++) {
+    threads.emplace_back([&]() {
+      int value;
+      while (popped.load() < 40000) {
+        if (queue.TryPop(value)) {
+          sum += value;
+          popped++;
+        } else {
+          this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+  CHECK(sum == 4 * 50005000L);
+}
+
+// Occupies the single worker of a queue until released
+struct Gate {
+  Gate() : release(), opened(release.get_future().share()) {}
+  promise<void> release;
+  shared_future<void> opened;
+  void Block(NotificationQueue &queue) {
+    promise<void> started;
+    auto running = started.get_future();
+    queue.Submit([this, &started]() {
+      started.set_value();
+      opened.wait();
+    });
+    running.wait();
+  }
+};
+
+TEST_CASE("notification queue overflow policies") {
+  SUBCASE("drop") {
+    NotificationQueue queue({2, 1, OverflowPolicy::drop});
+    Gate gate;
+    gate.Block(queue);
+    atomic<int> runs(0);
+    CHECK(queue.Submit([&runs]() { runs++; }));
+    CHECK(queue.Submit([&runs]() { runs++; }));
+    CHECK(!queue.Submit([&runs]() { runs++; }));
+    auto s = queue.Statistics();
+    CHECK(s.depth == 2);
+    CHECK(s.max_depth == 2);
+    CHECK(s.dropped == 1);
+    gate.release.set_value();
+    queue.Drain();
+    CHECK(runs == 2);
+    s = queue.Statistics();
+    CHECK(s.depth == 0);
+    CHECK(s.enqueued == 3);
+    CHECK(s.completed == 3);
+  }
+  SUBCASE("run inline") {
+    NotificationQueue queue({2, 1, OverflowPolicy::run_inline});
+    Gate gate;
+    gate.Block(queue);
+    thread::id caller;
+    CHECK(queue.Submit([]() {}));
+    CHECK(queue.Submit([]() {}));
+    CHECK(queue.Submit([&caller]() { caller = this_thread::get_id(); }));
+    CHECK(caller == this_thread::get_id());
+    CHECK(queue.Statistics().ran_inline == 1);
+    gate.release.set_value();
+  }
+  SUBCASE("block") {
+    NotificationQueue queue({2, 1, OverflowPolicy::block});
+    Gate gate;
+    gate.Block(queue);
+    atomic<int> runs(0);
+    CHECK(queue.Submit([&runs]() { runs++; }));
+    CHECK(queue.Submit([&runs]() { runs++; }));
+    auto producer = async(launch::async, [&]() { return queue.Submit([&runs]() { runs++; }); });
+    CHECK(producer.wait_for(chrono::milliseconds(20)) == future_status::timeout);
+    gate.release.set_value();
+    CHECK(producer.get());
+    queue.Drain();
+    CHECK(runs == 3);
+    CHECK(queue.Statistics().dropped == 0);
+  }
+}
+
+TEST_CASE("failing tasks are counted") {
+  NotificationQueue queue({8, 2, OverflowPolicy::drop});
+  queue.Submit([]() { throw std::runtime_error("failed"); });
+  queue.Submit([]() {});
+  queue.Drain();
+  CHECK(queue.Statistics().completed == 2);
+  CHECK(queue.Statistics().failed == 1);
+}
+
+static int add(int a, int b) { return a + b; }
+
+TEST_CASE("server runs notifications asynchronously") {
+  JsonRpc2Server server;
+  promise<void> release;
+  shared_future<void> opened = release.get_future().share();
+  atomic<int> logged(0);
+  REQUIRE(server.Add("log", GetUncheckedNotificationHandle([&](const json &params) {
+                       opened.wait();
+                       logged += params[0].get<int>();
+                     })));
+  REQUIRE(server.Add("add", GetHandle(&add), {"a", "b"}));
+  server.EnableAsyncNotifications({16, 2, OverflowPolicy::drop});
+
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","method":"log","params":[1]})").empty());
+  json batch = json::parse(server.HandleRequest(R"([{"jsonrpc":"2.0","method":"log","params":[2]},{"jsonrpc":"2.0","id":1,"method":"add","params":[1,2]},)"
+                                                R"({"jsonrpc":"2.0","method":"unknown"}])"));
+  CHECK(batch == json::parse(R"([{"id":1,"jsonrpc":"2.0","result":3}])"));
+  CHECK(logged == 0);
+
+  release.set_value();
+  server.WaitForNotifications();
+  CHECK(logged == 3);
+  auto s = server.GetNotificationQueueStatistics();
+  CHECK(s.enqueued == 3);
+  CHECK(s.completed == 3);
+  CHECK(s.failed == 1);
+  CHECK(json(s)["max_depth"].get<size_t>() >= 1);
+}
@@ -0,0 +1,68 @@
+#include "doctest/doctest.h"
+#include <jsonrpccxx/client.hpp>
+#include <jsonrpccxx/reader.hpp>
+#include <limits>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+template <typename T>
+static bool read_by_sax(const string &response, T &value) {
+  ResultSax<T> sax;
+  if (!json::sax_parse(response, &sax) || !sax.Complete())
+    return false;
+  value = std::move(sax.Value());
+  return true;
+}
+
+template <typename T>
+static void check_read(const json &result) {
+  string response = json{{"id", 1}, {"jsonrpc", "2.0"}, {"result", result}}.dump();
+  T value;
+  INFO(response);
+  REQUIRE(read_by_sax(response, value));
+  CHECK(value == result.get<T>());
+  CHECK(parse_result<T>(response) == result.get<T>());
+}
+
+TEST_CASE("result readers match json::get") {
+  CHECK(has_result_reader<int>::value);
+  CHECK(has_result_reader<vector<vector<string>>>::value);
+  CHECK(!has_result_reader<json>::value);
+  CHECK(!has_result_reader<vector<json>>::value);
+
+  check_read<bool>(true);
+  check_read<int>(-42);
+  check_read<unsigned long long>(numeric_limits<unsigned long long>::max());
+  check_read<double>(1.5);
+  check_read<double>(7);
+  check_read<string>("a\"b\n\xc3\xa9");
+  check_read<vector<int>>(json::array());
+  check_read<vector<int>>({1, -2, 3});
+  check_read<vector<vector<string>>>({{"a", "b"}, json::array(), {"c"}});
+  check_read<vector<bool>>({true, false});
+}
+
+TEST_CASE("responses the readers don't accept are decoded via the dom") {
+  int value = 0;
+  string response = R"({"id":1,"jsonrpc":"2.0","result":2.7})";
+  CHECK(!read_by_sax(response, value));
+  CHECK(parse_result<int>(response) == 2);
+
+  vector<int> values;
+  CHECK(!read_by_sax(R"({"id":1,"result":[1,null]})", values));
+  CHECK_THROWS_AS(parse_result<vector<int>>(R"({"id":1,"result":[1,null]})"), json::type_error);
+  CHECK_THROWS_AS(parse_result<vector<int>>(R"({"id":1,"result":{"a":1}})"), json::type_error);
+
+  CHECK(!read_by_sax(R"({"id":1,"jsonrpc":"2.0","error":{"code":-32601,"message":"method not found"},"result":1})", value));
+  CHECK_THROWS_WITH(parse_result<int>(R"({"result":1,"id":1,"error":{"code":-32601,"message":"method not found"}})"), "-32601: method not found");
+  CHECK(!read_by_sax(R"({"jsonrpc":"2.0","result":1})", value));
+  CHECK_THROWS_WITH(parse_result<int>(R"({"jsonrpc":"2.0","result":1})"), R"(-32603: invalid server response: neither "result" nor "error" fields found)");
+  CHECK(!read_by_sax(R"([{"id":1,"result":1}])", value));
+  CHECK(!read_by_sax(R"({"id":1,"result":1)", value));
+  CHECK_THROWS_AS(parse_result<int>(R"({"id":1,"result":1)"), JsonRpcException);
+
+  CHECK(read_by_sax(R"({"id":{"nested":[1,{"a":null}]},"meta":[[true]],"result":5,"jsonrpc":"2.0"})", value));
+  CHECK(value == 5);
+  CHECK(parse_result<json>(R"({"id":1,"result":{"a":[1,2]}})") == json{{"a", {1, 2}}});
+}
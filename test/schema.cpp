@@ -0,0 +1,115 @@
+#include "doctest/doctest.h"
+#include "testserverconnector.hpp"
+#include <jsonrpccxx/schema.hpp>
+#include <jsonrpccxx/server.hpp>
+#include <stdexcept>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+static string violation(const Schema &schema, const json &value) {
+  string error;
+  CHECK(!schema.Validate(value, error));
+  return error;
+}
+
+TEST_CASE("schema validation") {
+  string error;
+  CHECK(Schema().Validate({{"anything", {1, "a", nullptr}}}, error));
+
+  Schema number(json{{"type", "number"}, {"minimum", 0}, {"exclusiveMaximum", 10}});
+  CHECK(number.Validate(0, error));
+  CHECK(number.Validate(9.5, error));
+  CHECK(violation(number, -1) == "must be >= 0");
+  CHECK(violation(number, 10) == "must be < 10");
+  CHECK(violation(number, "5") == "must be number, but is string");
+
+  Schema integer(json{{"type", "integer"}});
+  CHECK(integer.Validate(3, error));
+  CHECK(integer.Validate(3.0, error));
+  CHECK(violation(integer, 3.5) == "must be integer, but is number");
+
+  Schema text(json{{"type", {"string", "null"}}, {"minLength", 1}, {"maxLength", 4}});
+  CHECK(text.Validate(nullptr, error));
+  CHECK(text.Validate("caf\xc3\xa9", error));
+  CHECK(violation(text, "") == "must be at least 1 characters long");
+  CHECK(violation(text, "longer") == "must be at most 4 characters long");
+  CHECK(violation(text, 1) == "must be null or string, but is number");
+
+  Schema order(json{{"type", "object"},
+                    {"required", {"id", "lines"}},
+                    {"additionalProperties", false},
+                    {"properties",
+                     {{"id", {{"type", "string"}}},
+                      {"note", {{"type", "string"}}},
+                      {"lines",
+                       {{"type", "array"},
+                        {"minItems", 1},
+                        {"items", {{"type", "object"}, {"required", {"count"}}, {"properties", {{"count", {{"type", "integer"}, {"minimum", 1}}}}}}}}}}}});
+  CHECK(order.Validate({{"id", "o1"}, {"lines", {{{"count", 2}}}}}, error));
+  CHECK(violation(order, {{"id", "o1"}}) == "missing required property \"lines\"");
+  CHECK(violation(order, {{"id", "o1"}, {"lines", json::array()}}) == "must have at least 1 items at /lines");
+  CHECK(violation(order, {{"id", "o1"}, {"lines", {{{"count", 2}}, {{"count", 0}}}}}) == "must be >= 1 at /lines/1/count");
+  CHECK(violation(order, {{"id", "o1"}, {"lines", {{{"count", 2}}, json::object()}}}) == "missing required property \"count\" at /lines/1");
+  CHECK(violation(order, {{"id", "o1"}, {"lines", {{{"count", 2}}}}, {"extra", true}}) == "unexpected property \"extra\"");
+  CHECK(order.Document()["required"] == json{"id", "lines"});
+
+  CHECK_THROWS_AS(Schema(json{{"type", "decimal"}}), std::invalid_argument);
+  CHECK_THROWS_AS(Schema(json{{"minLength", -1}}), std::invalid_argument);
+  CHECK_THROWS_AS(Schema(json{{"items", {{"maximum", "10"}}}}), std::invalid_argument);
+  CHECK_THROWS_AS(Schema(json{{"additionalProperties", {{"type", "string"}}}}), std::invalid_argument);
+  CHECK_THROWS_AS(Schema(json("string")), std::invalid_argument);
+}
+
+static int reserve(const json &item, int count) { return item["stock"].get<int>() - count; }
+static bool ping() { return true; }
+
+TEST_CASE("method contracts") {
+  JsonRpc2Server server;
+  TestServerConnector connector(server);
+  MethodOptions options;
+  options.contract = {{{"type", "object"}, {"required", {"stock"}}, {"properties", {{"stock", {{"type", "integer"}, {"minimum", 0}}}}}},
+                      {{"type", "integer"}, {"minimum", 1}, {"maximum", 100}}};
+  REQUIRE(server.Add("reserve", GetHandle(&reserve), {"item", "count"}, options));
+
+  connector.CallMethod(1, "reserve", {{{"stock", 10}}, 3});
+  CHECK(connector.VerifyMethodResult(1) == 7);
+  connector.CallMethod(2, "reserve", {{"item", {{"stock", -1}}}, {"count", 3}});
+  connector.VerifyMethodError(invalid_params, "invalid parameter: must be >= 0 at /stock for parameter \"item\"", 2);
+  connector.CallMethod(3, "reserve", {json::object(), 3});
+  connector.VerifyMethodError(invalid_params, "invalid parameter: missing required property \"stock\" for parameter \"item\"", 3);
+  connector.CallMethod(4, "reserve", {{{"stock", 10}}, 101});
+  connector.VerifyMethodError(invalid_params, "invalid parameter: must be <= 100 for parameter \"count\"", 4);
+  connector.CallMethod(5, "reserve", {{{"stock", 10}}});
+  connector.VerifyMethodError(invalid_params, "invalid parameter: expected 2 argument(s), but found 1", 5);
+
+  MethodOptions invalid;
+  invalid.contract = {{{"type", "decimal"}}};
+  CHECK_THROWS_AS(server.Add("broken", GetHandle(&reserve), {"item", "count"}, invalid), std::invalid_argument);
+  connector.CallMethod(6, "broken", {{{"stock", 10}}, 3});
+  connector.VerifyMethodError(method_not_found, "method not found: broken", 6);
+}
+
+TEST_CASE("contracts are served via rpc.discover") {
+  JsonRpc2Server server;
+  TestServerConnector connector(server);
+  MethodOptions options;
+  options.contract = {json::object(), {{"type", "integer"}, {"minimum", 1}}};
+  REQUIRE(server.Add("reserve", GetHandle(&reserve), {"item", "count"}, options));
+  REQUIRE(server.Add("ping", GetHandle(&ping)));
+  server.EnableStatistics();
+
+  connector.CallMethod(1, "rpc.discover", json::array());
+  connector.VerifyMethodError(method_not_found, "method not found: rpc.discover", 1);
+
+  server.EnableDiscovery();
+  connector.CallMethod(2, "rpc.discover", json::array());
+  json methods = connector.VerifyMethodResult(2)["methods"];
+  REQUIRE(methods.size() == 2);
+  CHECK(methods[0]["name"] == "ping");
+  CHECK(methods[0]["params"] == json::array());
+  CHECK(methods[1]["name"] == "reserve");
+  CHECK(methods[1]["paramStructure"] == "either");
+  CHECK(methods[1]["params"] == json{{{"name", "item"}, {"schema", json::object()}, {"required", true}},
+                                     {{"name", "count"}, {"schema", {{"type", "integer"}, {"minimum", 1}}}, {"required", true}}});
+}
@@ -1,6 +1,8 @@
+#include "../examples/inmemoryconnector.hpp"
 #include "doctest/doctest.h"
 #include "testserverconnector.hpp"
 #include <iostream>
+#include <jsonrpccxx/client.hpp>
 #include <jsonrpccxx/server.hpp>
 
 using namespace jsonrpccxx;
@@ -180,3 +182,104 @@ TEST_CASE_FIXTURE(Server2, "v2_batch") {
   batchresponse = connector.VerifyBatchResponse();
   REQUIRE(batchresponse.empty());
 }
+
+TEST_CASE("v1_server") {
+  JsonRpc1Server server;
+  TestServer t;
+  REQUIRE(server.Add("add_function", GetHandle(&TestServer::add_function, t), {"a", "b"}));
+  REQUIRE(server.Add("some_procedure", GetHandle(&TestServer::some_procedure, t), {"param"}));
+
+  CHECK(server.HandleRequest(R"({"id":1,"method":"add_function","params":[3,4]})") == R"({"error":null,"id":1,"result":7})");
+  CHECK(server.HandleRequest(R"({"id":"a","method":"add_function","params":{"a":3,"b":4}})") == R"({"error":null,"id":"a","result":7})");
+  CHECK(server.HandleRequest(R"({"id":[1],"method":"add_function","params":[1,1]})") == R"({"error":null,"id":[1],"result":2})");
+  CHECK(server.HandleRequest(R"({"id":null,"method":"some_procedure","params":["v1"]})").empty());
+  CHECK(t.param_proc == "v1");
+
+  json error = json::parse(server.HandleRequest(R"({"id":2,"method":"unknown","params":[]})"));
+  CHECK(error == json{{"error", {{"code", -32601}, {"message", "method not found: unknown"}}}, {"id", 2}, {"result", nullptr}});
+  error = json::parse(server.HandleRequest(R"({"method":"add_function","params":[1,2]})"));
+  CHECK(error["error"]["code"] == -32600);
+  CHECK(error["id"].is_null());
+  error = json::parse(server.HandleRequest(R"({"id":3,"method":"add_function","params":[1]})"));
+  CHECK(error["error"]["message"] == "invalid parameter: expected 2 argument(s), but found 1");
+  CHECK(error["id"] == 3);
+  error = json::parse(server.HandleRequest("{"));
+  CHECK(error["error"]["code"] == -32700);
+  CHECK(error.contains("result"));
+
+  json batch = json::parse(server.HandleRequest(R"([{"id":1,"method":"add_function","params":[1,2]},{"id":null,"method":"some_procedure","params":["b"]},)"
+                                                R"({"id":2,"method":"add_function","params":[3,4]}])"));
+  CHECK(batch == json{{{"error", nullptr}, {"id", 1}, {"result", 3}}, {{"error", nullptr}, {"id", 2}, {"result", 7}}});
+  CHECK(t.param_proc == "b");
+}
+
+TEST_CASE("v1_server_with_client") {
+  JsonRpc1Server server;
+  TestServer t;
+  REQUIRE(server.Add("add_function", GetHandle(&TestServer::add_function, t), {"a", "b"}));
+  REQUIRE(server.Add("some_procedure", GetHandle(&TestServer::some_procedure, t), {"param"}));
+  InMemoryConnector connector(server);
+  JsonRpcClient client(connector, version::v1);
+
+  CHECK(client.CallMethod<unsigned int>(1, "add_function", {1, 2}) == 3);
+  CHECK(client.CallMethodNamed<unsigned int>("x", "add_function", {{"a", 5}, {"b", 6}}) == 11);
+  client.CallNotification("some_procedure", {"from client"});
+  CHECK(t.param_proc == "from client");
+  CHECK_THROWS_WITH(client.CallMethod<int>(1, "unknown", {}), "-32601: method not found: unknown");
+}
+
+TEST_CASE("ids are echoed unchanged") {
+  JsonRpc2Server server;
+  TestServer t;
+  REQUIRE(server.Add("add_function", GetHandle(&TestServer::add_function, t), {"a", "b"}));
+
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":9223372036854775807,"method":"add_function","params":[1,2]})") ==
+        R"({"id":9223372036854775807,"jsonrpc":"2.0","result":3})");
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":"a\"b","method":"add_function","params":[1,2]})") == R"({"id":"a\"b","jsonrpc":"2.0","result":3})");
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":-1,"method":"unknown"})") ==
+        R"({"error":{"code":-32601,"message":"method not found: unknown"},"id":-1,"jsonrpc":"2.0"})");
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":[1],"method":"unknown"})") ==
+        R"({"error":{"code":-32600,"message":"invalid request: id field must be a number, string or null"},"id":null,"jsonrpc":"2.0"})");
+}
+
+TEST_CASE("envelope checks keep their precedence") {
+  JsonRpc2Server server;
+  TestServer t;
+  REQUIRE(server.Add("add_function", GetHandle(&TestServer::add_function, t), {"a", "b"}));
+
+  json error = json::parse(server.HandleRequest(R"({"params":1,"id":[],"method":2,"jsonrpc":"1.0"})"));
+  CHECK(error["error"]["message"] == R"(invalid request: missing jsonrpc field set to "2.0")");
+  error = json::parse(server.HandleRequest(R"({"params":1,"id":[],"method":2,"jsonrpc":"2.0"})"));
+  CHECK(error["error"]["message"] == "invalid request: method field must be a string");
+  error = json::parse(server.HandleRequest(R"({"params":1,"id":[],"method":"add_function","jsonrpc":"2.0"})"));
+  CHECK(error["error"]["message"] == "invalid request: id field must be a number, string or null");
+  error = json::parse(server.HandleRequest(R"({"params":1,"id":4,"method":"add_function","jsonrpc":"2.0"})"));
+  CHECK(error["error"]["message"] == "invalid request: params field must be an array, object or null");
+  CHECK(error["id"] == 4);
+  CHECK(server.HandleRequest(R"({"extra":{"id":5},"id":6,"method":"add_function","jsonrpc":"2.0","params":[1,2]})") ==
+        R"({"id":6,"jsonrpc":"2.0","result":3})");
+  error = json::parse(server.HandleRequest(R"([1,{"jsonrpc":"2.0","id":7,"method":"add_function","params":[2,2]}])"));
+  CHECK(error[0]["error"]["message"] == R"(invalid request: missing jsonrpc field set to "2.0")");
+  CHECK(error[1]["result"] == 4);
+}
+
+TEST_CASE("rpc_discover") {
+  JsonRpc2Server server;
+  TestServer t;
+  REQUIRE(server.Add("add_function", GetHandle(&TestServer::add_function, t), {"a", "b"}));
+  server.EnableDiscovery("test", "2.1.0");
+  REQUIRE(server.Add("some_procedure", GetHandle(&TestServer::some_procedure, t)));
+  REQUIRE(server.Add("raw", GetUncheckedHandle([](const json &params) { return params; })));
+  CHECK(!server.Add("rpc.discover", GetUncheckedHandle([](const json &params) { return params; })));
+
+  string response = server.HandleRequest(R"({"jsonrpc":"2.0","id":1,"method":"rpc.discover"})");
+  json document = json::parse(response)["result"];
+  CHECK(document["openrpc"] == "1.3.2");
+  CHECK(document["info"] == json{{"title", "test"}, {"version", "2.1.0"}});
+  REQUIRE(document["methods"].size() == 3);
+  CHECK(document["methods"][0] == R"({"name":"add_function","paramStructure":"either","params":[{"name":"a","required":true,"schema":{"type":"integer","minimum":0}},
+    {"name":"b","required":true,"schema":{"type":"integer","minimum":0}}],"result":{"name":"result","schema":{"type":"integer","minimum":0}}})"_json);
+  CHECK(document["methods"][1] == R"({"name":"raw","paramStructure":"by-position","params":[],"result":{"name":"result","schema":{}}})"_json);
+  CHECK(document["methods"][2] == R"({"name":"some_procedure","paramStructure":"by-position","params":[{"name":"0","required":true,"schema":{"type":"string"}}]})"_json);
+  CHECK(response.find(document.dump()) != string::npos);
+}
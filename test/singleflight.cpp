@@ -0,0 +1,99 @@
+#include "doctest/doctest.h"
+#include <atomic>
+#include <future>
+#include <jsonrpccxx/server.hpp>
+#include <jsonrpccxx/singleflight.hpp>
+#include <thread>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+TEST_CASE("single flight shares results of concurrent calls") {
+  SingleFlight flight;
+  promise<void> release;
+  shared_future<void> released = release.get_future().share();
+  atomic<int> executions(0);
+  auto execute = [&](string &result) {
+    executions++;
+    released.wait();
+    result += "42";
+  };
+
+  vector<future<string>> callers;
+  for (int i = 0; i < 4; i++) {
+    callers.push_back(async(launch::async, [&]() {
+      string out;
+      flight.Do({1, 2}, out, execute);
+      return out;
+    }));
+  }
+  while (flight.Waiters() < 3)
+    this_thread::yield();
+  string other;
+  flight.Do({2, 1}, other, [](string &result) { result += "other"; });
+  CHECK(other == "other");
+
+  release.set_value();
+  for (auto &c : callers)
+    CHECK(c.get() == "42");
+  CHECK(executions == 1);
+  CHECK(flight.Waiters() == 0);
+
+  string out;
+  flight.Do({1, 2}, out, execute);
+  CHECK(executions == 2);
+}
+
+TEST_CASE("single flight shares errors of concurrent calls") {
+  SingleFlight flight;
+  promise<void> release;
+  shared_future<void> released = release.get_future().share();
+  auto execute = [&](string &) {
+    released.wait();
+    throw JsonRpcException(-32001, "failed");
+  };
+
+  vector<future<void>> callers;
+  for (int i = 0; i < 3; i++) {
+    callers.push_back(async(launch::async, [&]() {
+      string out;
+      flight.Do({"a"}, out, execute);
+    }));
+  }
+  while (flight.Waiters() < 2)
+    this_thread::yield();
+  release.set_value();
+  for (auto &c : callers)
+    CHECK_THROWS_WITH(c.get(), "-32001: failed");
+}
+
+TEST_CASE("single flight methods answer with their own ids") {
+  JsonRpc2Server server;
+  atomic<int> executions(0);
+  atomic<int> arrived(0);
+  MethodOptions options;
+  options.single_flight = true;
+  REQUIRE(server.Add("slow", GetUncheckedHandle([&](const json &params) -> json {
+                       executions++;
+                       while (arrived < 8)
+                         this_thread::yield();
+                       this_thread::sleep_for(chrono::milliseconds(50));
+                       return params[0];
+                     }),
+                     {"value"}, options));
+
+  vector<future<json>> callers;
+  for (int i = 0; i < 8; i++) {
+    callers.push_back(async(launch::async, [&server, &arrived, i]() {
+      json request = {{"jsonrpc", "2.0"}, {"id", i}, {"method", "slow"}, {"params", {{"value", "x"}}}};
+      arrived++;
+      return json::parse(server.HandleRequest(request.dump()));
+    }));
+  }
+  for (int i = 0; i < 8; i++) {
+    json response = callers[i].get();
+    CHECK(response["id"] == i);
+    CHECK(response["result"] == "x");
+  }
+  CHECK(executions < 8);
+}
@@ -0,0 +1,121 @@
+#include "doctest/doctest.h"
+#include "testserverconnector.hpp"
+#include <jsonrpccxx/staticserver.hpp>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+class Calculator {
+public:
+  Calculator() : notified(0) {}
+  int Add(int a, int b) const { return a + b; }
+  string Concat(const string &a, const string &b) { return a + b; }
+  void Notify(int value) { notified += value; }
+  int notified;
+};
+
+static unsigned int twice(unsigned int value) { return 2 * value; }
+
+static constexpr char add[] = "add";
+static constexpr char concat[] = "concat";
+static constexpr char notify[] = "notify";
+static constexpr char twice_name[] = "twice";
+static constexpr char a[] = "a";
+static constexpr char b[] = "b";
+
+typedef Methods<Method<add, &Calculator::Add, a, b>, Method<concat, &Calculator::Concat>, Method<notify, &Calculator::Notify>, Method<twice_name, &twice>>
+    CalculatorMethods;
+
+TEST_CASE("static dispatcher") {
+  static_assert(Method<add, &Calculator::Add>::hash == method_hash("add", 3), "hash is computed at compile time");
+  Calculator calculator;
+  StaticDispatcher<Calculator, CalculatorMethods> d(calculator);
+
+  CHECK(d.ContainsMethod("add"));
+  CHECK(d.ContainsMethod("twice"));
+  CHECK(!d.ContainsMethod("notify"));
+  CHECK(d.ContainsNotification("notify"));
+  CHECK(!d.ContainsMethod("ad"));
+
+  CHECK(d.InvokeMethod("add", {1, 2}) == 3);
+  CHECK(d.InvokeMethod("add", {{"a", 3}, {"b", 4}}) == 7);
+  CHECK(d.InvokeMethod("concat", {"a", "b"}) == "ab");
+  CHECK(d.InvokeMethod("twice", {21}) == 42);
+  string out = "[";
+  CHECK(d.TryInvokeMethod("add", {1, 1}, out));
+  CHECK(!d.TryInvokeMethod("unknown", {1, 1}, out));
+  CHECK(out == "[2");
+
+  d.InvokeNotification("notify", {5});
+  CHECK(calculator.notified == 5);
+  CHECK(!d.TryInvokeNotification("add", {1, 2}));
+  CHECK_THROWS_WITH(d.InvokeMethod("notify", {1}), "-32601: method not found: notify");
+  CHECK_THROWS_WITH(d.InvokeNotification("add", {1}), "-32601: notification not found: add");
+}
+
+TEST_CASE("static dispatcher errors match dynamic dispatcher") {
+  Calculator calculator;
+  StaticJsonRpc2Server<Calculator, CalculatorMethods> server(calculator);
+  JsonRpc2Server dynamic;
+  dynamic.Add("add", GetHandle(&Calculator::Add, static_cast<const Calculator &>(calculator)), {"a", "b"});
+  dynamic.Add("concat", GetHandle(&Calculator::Concat, calculator));
+  dynamic.Add("twice", GetHandle(&twice));
+
+  vector<pair<string, json>> calls = {{"add", {1}},           {"add", {1, "2"}},       {"add", {{"a", 1}}},  {"concat", {{"a", "x"}, {"b", "y"}}},
+                                      {"twice", {-1}},        {"add", {1, 2.5}},       {"unknown", {}},      {"add", {{"a", 1}, {"b", true}}},
+                                      {"concat", {"a", "b"}}, {"add", {1, 2}}};
+  for (auto &call : calls) {
+    CAPTURE(call.first);
+    CAPTURE(call.second);
+    json request = TestServerConnector::BuildMethodCall(1, call.first, call.second);
+    CHECK(server.HandleRequest(request.dump()) == dynamic.HandleRequest(request.dump()));
+  }
+}
+
+TEST_CASE("static server falls back to dynamic methods") {
+  Calculator calculator;
+  StaticJsonRpc2Server<Calculator, CalculatorMethods> server(calculator);
+  TestServerConnector connector(server);
+  REQUIRE(server.Add("sub", GetHandle(std::function<int(int, int)>([](int x, int y) { return x - y; }))));
+  int dynamicNotifications = 0;
+  REQUIRE(server.Add("ping", GetHandle(std::function<void()>([&dynamicNotifications]() { dynamicNotifications++; }))));
+
+  connector.CallMethod(1, "add", {1, 2});
+  CHECK(connector.VerifyMethodResult(1) == 3);
+  connector.CallMethod(2, "sub", {5, 2});
+  CHECK(connector.VerifyMethodResult(2) == 3);
+  connector.CallMethod(3, "mul", {5, 2});
+  connector.VerifyMethodError(-32601, "method not found: mul", 3);
+
+  connector.CallNotification("notify", {2});
+  connector.VerifyNotificationResult();
+  connector.CallNotification("ping", {});
+  CHECK(calculator.notified == 2);
+  CHECK(dynamicNotifications == 1);
+
+  connector.SendRawRequest(R"([{"jsonrpc":"2.0","id":1,"method":"add","params":[1,1]},{"jsonrpc":"2.0","method":"notify","params":[1]},)"
+                           R"({"jsonrpc":"2.0","id":2,"method":"sub","params":[1,1]}])");
+  json response = connector.VerifyBatchResponse();
+  REQUIRE(response.size() == 2);
+  CHECK(response[0]["result"] == 2);
+  CHECK(response[1]["result"] == 0);
+  CHECK(calculator.notified == 3);
+}
+
+TEST_CASE("static server runs interceptors") {
+  Calculator calculator;
+  StaticJsonRpc2Server<Calculator, CalculatorMethods> server(calculator);
+  TestServerConnector connector(server);
+  vector<string> seen;
+  server.AddInterceptor([&seen](RequestContext &context, const Next &next) {
+    seen.push_back(context.method);
+    context.params[0] = 10;
+    next();
+  });
+
+  connector.CallMethod(1, "add", {1, 2});
+  CHECK(connector.VerifyMethodResult(1) == 12);
+  connector.CallNotification("notify", {1});
+  CHECK(calculator.notified == 10);
+  CHECK(seen == vector<string>{"add", "notify"});
+}
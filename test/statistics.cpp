@@ -0,0 +1,101 @@
+#include "doctest/doctest.h"
+#include "testserverconnector.hpp"
+#include <jsonrpccxx/dispatcher.hpp>
+#include <jsonrpccxx/server.hpp>
+#include <jsonrpccxx/statistics.hpp>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+static int multiply(int a, int b) { return a * b; }
+static void notify(const string &) {}
+static int fail(int code) { throw JsonRpcException(code, "failure"); }
+
+TEST_CASE("histogram buckets") {
+  for (uint64_t v = 0; v < histogram::sub_bucket_count; v++) {
+    CHECK(histogram::bucket_index(v) == v);
+    CHECK(histogram::bucket_upper_bound(v) == v);
+  }
+  for (uint64_t v : {8ull, 9ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, 60000000000ull}) {
+    size_t index = histogram::bucket_index(v);
+    CHECK(histogram::bucket_upper_bound(index) >= v);
+    CHECK(histogram::bucket_upper_bound(index - 1) < v);
+  }
+  CHECK(histogram::bucket_index(~0ull) == histogram::bucket_count - 1);
+}
+
+TEST_CASE("statistics percentiles") {
+  MethodStatistics s;
+  for (uint64_t i = 1; i <= 1000; i++)
+    s.Record(i * 1000);
+  s.Record(5000, invalid_params);
+  MethodStatisticsSnapshot snapshot = s.Snapshot();
+  CHECK(snapshot.calls == 1001);
+  CHECK(snapshot.Errors() == 1);
+  CHECK(snapshot.Errors(invalid_params) == 1);
+  CHECK(snapshot.max_ns == 1000000);
+  CHECK(snapshot.Percentile(0.5) >= 500000);
+  CHECK(snapshot.Percentile(0.5) <= 500000 * 1.125);
+  CHECK(snapshot.Percentile(0.99) >= 990000);
+  CHECK(snapshot.Percentile(1.0) == 1000000);
+
+  s.Reset();
+  CHECK(s.Snapshot().calls == 0);
+  CHECK(s.Snapshot().Percentile(0.5) == 0);
+}
+
+TEST_CASE("dispatcher statistics") {
+  Dispatcher d;
+  CHECK(d.Add("multiply", GetHandle(&multiply)));
+  d.InvokeMethod("multiply", {2, 3});
+  CHECK(d.GetStatistics().empty());
+
+  d.EnableStatistics();
+  CHECK(d.Add("notify", GetHandle(&notify)));
+  CHECK(d.Add("fail", GetHandle(&fail)));
+  d.InvokeMethod("multiply", {2, 3});
+  d.InvokeMethod("multiply", {4, 3});
+  CHECK_THROWS(d.InvokeMethod("multiply", {"a", 3}));
+  CHECK_THROWS(d.InvokeMethod("fail", {-32050}));
+  CHECK_THROWS(d.InvokeMethod("fail", {-32603}));
+  CHECK_THROWS(d.InvokeMethod("unknown", {1}));
+  d.InvokeNotification("notify", {"a"});
+
+  auto stats = d.GetStatistics();
+  REQUIRE(stats.size() == 3);
+  CHECK(stats["multiply"].calls == 3);
+  CHECK(stats["multiply"].Errors() == 1);
+  CHECK(stats["multiply"].Errors(invalid_params) == 1);
+  CHECK(stats["fail"].calls == 2);
+  CHECK(stats["fail"].Errors(-32050) == 1);
+  CHECK(stats["fail"].Errors(internal_error) == 1);
+  CHECK(stats["notify"].calls == 1);
+  CHECK(stats["notify"].Errors() == 0);
+
+  d.ResetStatistics();
+  CHECK(d.GetStatistics()["multiply"].calls == 0);
+}
+
+TEST_CASE("server rpc.stats") {
+  JsonRpc2Server server;
+  TestServerConnector connector(server);
+  REQUIRE(server.Add("multiply", GetHandle(&multiply)));
+
+  connector.CallMethod(1, "rpc.stats", nullptr);
+  connector.VerifyMethodError(-32601, "method not found: rpc.stats", 1);
+
+  server.EnableStatistics();
+  connector.CallMethod(1, "multiply", {3, 4});
+  CHECK(connector.VerifyMethodResult(1) == 12);
+  connector.CallMethod(2, "multiply", {3});
+  connector.VerifyMethodError(-32602, "expected 2 argument(s)", 2);
+
+  connector.CallMethod(3, "rpc.stats", nullptr);
+  json stats = connector.VerifyMethodResult(3);
+  CHECK(stats["multiply"]["calls"] == 2);
+  CHECK(stats["multiply"]["errors"]["invalid_params"] == 1);
+  CHECK(stats["multiply"]["latency_ns"]["max"].get<uint64_t>() >= stats["multiply"]["latency_ns"]["p50"].get<uint64_t>());
+
+  server.ResetStatistics();
+  CHECK(server.GetStatistics()["multiply"].calls == 0);
+}
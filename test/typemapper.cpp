@@ -1,11 +1,25 @@
 #include "doctest/doctest.h"
+#include <array>
+#include <cstdlib>
 #include <iostream>
 #include <jsonrpccxx/typemapper.hpp>
 #include <limits>
+#include <memory>
+#include <new>
 
 using namespace jsonrpccxx;
 using namespace std;
 
+static size_t allocations = 0;
+void *operator new(size_t size) {
+  allocations++;
+  if (void *p = malloc(size))
+    return p;
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
 static string notifyResult = "";
 
 int add(int a, int b) { return a + b; }
@@ -239,4 +253,108 @@ TEST_CASE("test json method handles without specific types") {
   NotificationHandle nh = GetUncheckedNotificationHandle(&arbitrary_json_notification);
   nh(R"([3,"string"])"_json);
   nh(R"({"3": "string"})"_json);
-}
\ No newline at end of file
+}
+TEST_CASE("test handle copy, move and storage") {
+  MethodHandle empty;
+  CHECK(!empty);
+  CHECK_THROWS_AS(empty(json::array()), std::bad_function_call);
+
+  std::array<char, 256> large{};
+  large[0] = 'x';
+  MethodHandle heap = GetUncheckedHandle([large](const json &) -> json { return std::string(1, large[0]); });
+  auto counter = std::make_shared<int>(0);
+  MethodHandle small = GetUncheckedHandle([counter](const json &) -> json { return ++*counter; });
+  CHECK(counter.use_count() == 2);
+
+  MethodHandle heapCopy = heap;
+  MethodHandle smallCopy = small;
+  CHECK(counter.use_count() == 3);
+  CHECK(heapCopy(json::array()) == "x");
+  CHECK(smallCopy(json::array()) == 1);
+
+  MethodHandle moved = std::move(small);
+  CHECK(!small);
+  CHECK(moved(json::array()) == 2);
+  heapCopy = std::move(moved);
+  CHECK(heapCopy(json::array()) == 3);
+  smallCopy = heap;
+  CHECK(counter.use_count() == 2);
+  CHECK(smallCopy(json::array()) == "x");
+  heapCopy = nullptr;
+  CHECK(counter.use_count() == 1);
+}
+
+static size_t join_size(string first, vector<string> rest) { return first.size() + rest.size(); }
+
+TEST_CASE("test owned params are moved instead of copied") {
+  MethodHandle mh = GetHandle(&join_size);
+  json params = {string(1000, 'a'), {string(1000, 'b'), string(1000, 'c')}};
+
+  size_t before = allocations;
+  json result = mh(params);
+  size_t copied = allocations - before;
+  CHECK(result == 1002);
+
+  before = allocations;
+  result = mh(std::move(params));
+  size_t moved = allocations - before;
+  CHECK(result == 1002);
+  // Only the vector buffer is allocated, the strings are taken from the request
+  CHECK(moved == 1);
+  CHECK(copied == 4);
+}
+
+static string greet(const string &name, const string &greeting, int times) {
+  string result;
+  for (int i = 0; i < times; i++)
+    result += greeting + " " + name + ";";
+  return result;
+}
+
+TEST_CASE("test param policies") {
+  MethodHandle strict = GetHandle(&greet);
+  CHECK(strict(R"(["a", "hi", 1])"_json) == "hi a;");
+  CHECK_THROWS_WITH(strict(R"(["a", "hi", 1, true])"_json), "-32602: invalid parameter: expected 3 argument(s), but found 4");
+
+  MethodHandle lenient = GetHandle(&greet, LenientParams());
+  CHECK(lenient(R"(["a", "hi", 1, true, {}])"_json) == "hi a;");
+  CHECK_THROWS_WITH(lenient(R"(["a", "hi"])"_json), "-32602: invalid parameter: expected at least 3 argument(s), but found 2");
+  CHECK_THROWS_WITH(lenient(R"(["a", "hi", "1", true])"_json), "-32602: invalid parameter: must be integer, but is string, data: 2");
+
+  MethodHandle defaulted = GetHandle(&greet, WithDefaults("hello", 2));
+  CHECK(defaulted.OptionalParams() == 2);
+  CHECK(strict.OptionalParams() == 0);
+  CHECK(defaulted(R"(["a"])"_json) == "hello a;hello a;");
+  CHECK(defaulted(R"(["a", "hi"])"_json) == "hi a;hi a;");
+  CHECK(defaulted(R"(["a", "hi", 1])"_json) == "hi a;");
+  CHECK_THROWS_WITH(defaulted(R"([])"_json), "-32602: invalid parameter: expected 1 to 3 argument(s), but found 0");
+  CHECK_THROWS_WITH(defaulted(R"(["a", "hi", 1, 2])"_json), "-32602: invalid parameter: expected 1 to 3 argument(s), but found 4");
+  CHECK_THROWS_WITH(defaulted(R"(["a", 2])"_json), "-32602: invalid parameter: must be string, but is unsigned integer, data: 1");
+
+  SomeClass instance;
+  MethodHandle member = GetHandle(&SomeClass::add, instance, WithDefaults(10));
+  CHECK(member(R"([1])"_json) == 11);
+  NotificationHandle notification = GetHandle(&notify, WithDefaults(string("default")));
+  notification(json::array());
+  CHECK(notifyResult == "Hello world: default");
+  notification(R"(["x"])"_json);
+  CHECK(notifyResult == "Hello world: x");
+}
+
+static vector<unsigned int> sizes(const vector<string> &values) {
+  vector<unsigned int> result;
+  for (auto const &v : values)
+    result.push_back(static_cast<unsigned int>(v.size()));
+  return result;
+}
+
+TEST_CASE("test handle descriptions") {
+  CHECK(GetHandle(&add).Describe() == R"({"params":[{"type":"integer"},{"type":"integer"}],"result":{"type":"integer"}})"_json);
+  CHECK(GetHandle(&notify).Describe() == R"({"params":[{"type":"string"}]})"_json);
+  CHECK(GetHandle(&sizes).Describe() ==
+        R"({"params":[{"type":"array","items":{"type":"string"}}],"result":{"type":"array","items":{"type":"integer","minimum":0}}})"_json);
+  SomeClass instance;
+  CHECK(GetHandle(&SomeClass::add, instance).Describe() == GetHandle(&add).Describe());
+  CHECK(GetUncheckedHandle([](const json &params) { return params; }).Describe().is_null());
+  CHECK(MethodHandle().Describe().is_null());
+}
@@ -0,0 +1,96 @@
+#include "doctest/doctest.h"
+#include "testserverconnector.hpp"
+#include <cmath>
+#include <jsonrpccxx/server.hpp>
+#include <jsonrpccxx/writer.hpp>
+#include <limits>
+
+using namespace jsonrpccxx;
+using namespace std;
+
+struct Point {
+  int x;
+  int y;
+};
+inline void to_json(json &j, const Point &p) { j = json{{"x", p.x}, {"y", p.y}}; }
+
+namespace jsonrpccxx {
+  template <>
+  struct result_writer<Point> {
+    static void write(std::string &out, const Point &p) {
+      out += "{\"x\":";
+      result_writer<int>::write(out, p.x);
+      out += ",\"y\":";
+      result_writer<int>::write(out, p.y);
+      out += '}';
+    }
+  };
+} // namespace jsonrpccxx
+
+struct Label {
+  string text;
+};
+inline void to_json(json &j, const Label &l) { j = json{{"text", l.text}}; }
+
+template <typename T>
+static void check_written(const T &value) {
+  string out;
+  write_result(out, value);
+  CHECK(out == json(value).dump());
+}
+
+TEST_CASE("result writers match json::dump") {
+  CHECK(has_result_writer<int>::value);
+  CHECK(has_result_writer<vector<string>>::value);
+  CHECK(has_result_writer<Point>::value);
+  CHECK(has_result_writer<vector<Point>>::value);
+  CHECK(!has_result_writer<Label>::value);
+  CHECK(!has_result_writer<vector<Label>>::value);
+
+  check_written(true);
+  check_written(0);
+  check_written(-42);
+  check_written(numeric_limits<long long>::min());
+  check_written(numeric_limits<unsigned long long>::max());
+  check_written(static_cast<short>(-7));
+  for (double d : {0.0, -0.0, 0.1, 1.0, -2.5, 1e300, 5e-324, 123456789.123})
+    check_written(d);
+  check_written(0.1f);
+  check_written(numeric_limits<double>::quiet_NaN());
+  check_written(numeric_limits<double>::infinity());
+  for (const char *s : {"", "plain", "quote\"", "back\\slash", "new\nline", "tab\t", "\x01\x7f", "caf\xc3\xa9"})
+    check_written(string(s));
+  check_written(vector<int>{});
+  check_written(vector<int>{1, -2, 3});
+  check_written(vector<bool>{true, false});
+  check_written(vector<double>{1.5, 2.0});
+  check_written(vector<vector<string>>{{"a", "b"}, {}});
+  check_written(Label{"fallback"});
+  check_written(json{{"b", 1}, {"a", {1, 2}}});
+
+  string out;
+  write_result(out, vector<Point>{{1, 2}, {3, 4}});
+  CHECK(out == R"([{"x":1,"y":2},{"x":3,"y":4}])");
+  CHECK_THROWS_AS(write_result(out, string("\xff")), json::type_error);
+}
+
+static vector<Point> points(int count) {
+  vector<Point> result;
+  for (int i = 0; i < count; i++)
+    result.push_back({i, -i});
+  return result;
+}
+static Label label(const string &text) { return {text}; }
+
+TEST_CASE("server writes results directly") {
+  JsonRpc2Server server;
+  TestServerConnector connector(server);
+  REQUIRE(server.Add("points", GetHandle(&points), {"count"}));
+  REQUIRE(server.Add("label", GetHandle(&label), {"text"}));
+
+  connector.CallMethod(1, "points", {2});
+  CHECK(connector.VerifyMethodResult(1) == json{{{"x", 0}, {"y", 0}}, {{"x", 1}, {"y", -1}}});
+  connector.CallMethod(2, "label", {"a\"b"});
+  CHECK(connector.VerifyMethodResult(2) == json{{"text", "a\"b"}});
+  CHECK(server.HandleRequest(R"({"jsonrpc":"2.0","id":3,"method":"points","params":[1]})") == R"({"id":3,"jsonrpc":"2.0","result":[{"x":0,"y":0}]})");
+}